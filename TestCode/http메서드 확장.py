@@ -1,6 +1,7 @@
 import requests
 import json
 import os
+import subprocess
 from pathlib import Path
 
 class WebServerTest:
@@ -59,6 +60,71 @@ class WebServerTest:
         print(f"GET /: {response.status_code}")
         assert response.status_code == 200
     
+    def test_path_security(self):
+        """경로 검증 테스트"""
+        print("\n=== Testing path security ===")
+
+        # 루트 밖으로 나가거나 인코딩을 악용하는 경로는 거부
+        for path in ["/%2e%2e/%2e%2e/windows/win.ini",
+                     "/images/%2e%2e%2f%2e%2e%2fsecret",
+                     "/%252e%252e/secret",
+                     "/test.txt%00.html",
+                     "/test.txt::$DATA",
+                     "/.hidden"]:
+            response = requests.get(f"{self.base_url}{path}")
+            print(f"GET {path}: {response.status_code}")
+            assert response.status_code == 403
+
+        # 점 세그먼트와 중복 슬래시는 정규화 후 제공
+        response = requests.get(f"{self.base_url}//images/%2e%2e/test.txt")
+        print(f"GET //images/%2e%2e/test.txt: {response.status_code}")
+        assert response.status_code == 200
+
+    def test_path_canonicalizer(self):
+        """경로 정규화 차등 테스트 (빌드된 path_bench 실행, 이전 is_path_safe와 비교)"""
+        print("\n=== Testing path canonicalizer against the old is_path_safe ===")
+
+        candidates = [Path("bin") / "path_bench.exe", Path("bin") / "path_bench"]
+        tool = next((path for path in candidates if path.exists()), None)
+        if tool is None:
+            print("path_bench not built, skipping")
+            return
+
+        result = subprocess.run([str(tool), "3", "50000"], capture_output=True, text=True, timeout=300)
+        print(result.stdout)
+        assert result.returncode == 0
+        assert "PASSED" in result.stdout
+
+    def test_conditional_get(self):
+        """조건부 GET 테스트"""
+        print("\n=== Testing conditional GET ===")
+
+        response = requests.get(f"{self.base_url}/test.txt")
+        etag = response.headers.get('ETag')
+        print(f"ETag: {etag}")
+        assert etag and etag.startswith('"')
+
+        # 같은 ETag (약한 비교, 목록 포함)는 304
+        for value in [etag, f'W/{etag}', f'"other", {etag}', '*']:
+            response = requests.get(f"{self.base_url}/test.txt", headers={'If-None-Match': value})
+            print(f"If-None-Match {value}: {response.status_code}")
+            assert response.status_code == 304
+            assert response.headers.get('ETag') == etag
+            assert len(response.content) == 0
+
+        # 다른 ETag는 If-Modified-Since와 관계없이 200
+        last_modified = response.headers.get('Last-Modified')
+        response = requests.get(f"{self.base_url}/test.txt",
+                                headers={'If-None-Match': '"other"', 'If-Modified-Since': last_modified})
+        print(f"If-None-Match mismatch: {response.status_code}")
+        assert response.status_code == 200
+
+        # If-Modified-Since는 날짜로 비교
+        response = requests.get(f"{self.base_url}/test.txt",
+                                headers={'If-Modified-Since': 'Fri, 31 Dec 9999 23:59:59 GMT'})
+        print(f"If-Modified-Since future: {response.status_code}")
+        assert response.status_code == 304
+
     def test_head(self):
         """HEAD 메소드 테스트"""
         print("\n=== Testing HEAD ===")
@@ -69,6 +135,43 @@ class WebServerTest:
         assert 'Content-Length' in response.headers
         assert 'Content-Type' in response.headers
         assert len(response.content) == 0  # HEAD는 본문이 없어야 함
+
+        # GET과 같은 헤더
+        get_response = requests.get(f"{self.base_url}/test.txt")
+        assert response.headers['Content-Length'] == get_response.headers['Content-Length']
+        assert response.headers['ETag'] == get_response.headers['ETag']
+        assert response.headers['Last-Modified'] == get_response.headers['Last-Modified']
+
+        # 캐시에 없는 파일의 HEAD와 뒤이은 GET이 같은 표현 (압축 가능한 크기의 텍스트)
+        cold_name = f"head_cold_{os.getpid()}.txt"
+        cold_path = Path("static") / cold_name
+        cold_path.write_text("HEAD and GET must agree. " * 200)
+        try:
+            gzip_only = {'Accept-Encoding': 'gzip'}
+            head = requests.head(f"{self.base_url}/{cold_name}", headers=gzip_only)
+            print(f"HEAD /{cold_name} (cold): {head.status_code}")
+            assert head.status_code == 200
+            assert len(head.content) == 0
+
+            get = requests.get(f"{self.base_url}/{cold_name}", headers=gzip_only, stream=True)
+            assert get.status_code == 200
+            for name in ('Content-Length', 'ETag', 'Last-Modified', 'Content-Encoding', 'Vary'):
+                assert head.headers.get(name) == get.headers.get(name), name
+            get.close()
+
+            # GET의 ETag로 HEAD 조건부 요청
+            response = requests.head(
+                f"{self.base_url}/{cold_name}",
+                headers={**gzip_only, 'If-None-Match': get.headers['ETag']}
+            )
+            assert response.status_code == 304
+        finally:
+            cold_path.unlink()
+
+        response = requests.head(f"{self.base_url}/nonexistent.txt")
+        print(f"HEAD /nonexistent.txt: {response.status_code}")
+        assert response.status_code == 404
+        assert len(response.content) == 0
     
     def test_post(self):
         """POST 메소드 테스트"""
@@ -121,6 +224,29 @@ class WebServerTest:
         response = requests.get(f"{self.base_url}/uploaded.txt")
         assert response.status_code == 200
         assert response.text == content
+
+        # 대소문자가 다른 요청으로 캐시 (NTFS는 같은 파일, 덮어쓰면 함께 무효화되어야 함)
+        response = requests.get(f"{self.base_url}/UPLOADED.TXT")
+        assert response.status_code == 200
+        assert response.text == content
+
+        # 요청 버퍼보다 큰 본문으로 덮어쓰기 (이전 캐시 대신 새 내용이 보여야 함)
+        large_content = "0123456789abcdef" * 16384
+        response = requests.put(
+            f"{self.base_url}/uploaded.txt",
+            data=large_content,
+            headers={'Content-Type': 'text/plain'}
+        )
+        print(f"PUT /uploaded.txt (large): {response.status_code}")
+        assert response.status_code == 201
+
+        response = requests.get(f"{self.base_url}/uploaded.txt")
+        assert response.status_code == 200
+        assert response.text == large_content
+
+        response = requests.get(f"{self.base_url}/UPLOADED.TXT")
+        assert response.status_code == 200
+        assert response.text == large_content
     
     def test_delete(self):
         """DELETE 메소드 테스트"""
@@ -148,6 +274,9 @@ def run_tests():
         # 모든 테스트 실행
         tests = [
             tester.test_get,
+            tester.test_path_security,
+            tester.test_path_canonicalizer,
+            tester.test_conditional_get,
             tester.test_head,
             tester.test_post,
             tester.test_put,
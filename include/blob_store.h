@@ -0,0 +1,26 @@
+/*
+ * 내용 주소 기반 업로드 저장소 (중복 제거)
+ * 1. 업로드 내용을 SHA-256으로 해시해 blob_dir\<해시>에 한 번만 저장
+ * 2. 업로드 파일 이름은 blob에 대한 하드 링크 (링크 수가 참조 카운트)
+ * 3. 이미 있는 내용이면 디스크 쓰기 없이 링크만 생성
+ * 4. 어떤 이름도 가리키지 않는 blob은 시작 시 정리
+ */
+
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include <stddef.h>
+
+// 저장소 열기 (blob_dir 생성, 고아 blob과 남은 임시 파일 삭제, 성공 시 0)
+int blob_store_init(const char *blob_dir);
+void blob_store_cleanup(void);
+int blob_store_enabled(void);
+
+// data를 blob으로 저장하고 target_path를 그 blob에 대한 링크로 원자적으로 교체
+// sync: 새 blob을 디스크까지 플러시, deduplicated: 기존 blob을 재사용했는지 (NULL 가능)
+int blob_store_put(const char *target_path, const void *data, size_t length, int sync, int *deduplicated);
+
+// 중복 제거 지표 출력
+void blob_store_print_stats(void);
+
+#endif // BLOB_STORE_H
@@ -0,0 +1,68 @@
+/*
+ * 정적 파일 번들 (배포용 단일 파일)
+ * 1. tools/bundle_builder로 static 폴더를 한 파일로 묶음
+ * 2. 경로 인덱스는 완전 해시 (해시 두 번 + 키 비교 한 번으로 조회)
+ * 3. 표현별 데이터는 페이지 정렬, ETag와 200 헤더 블록은 미리 생성
+ * 4. 서버는 시작 시 파일 전체를 매핑하고 stat/open 없이 뷰에서 바로 응답
+ */
+
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <stddef.h>
+#include "file_handler.h"
+
+#define BUNDLE_MAGIC "WSBUNDL1"
+#define BUNDLE_VERSION 1
+#define BUNDLE_ALIGN 4096 // 표현 데이터 정렬 단위 (페이지 크기)
+#define BUNDLE_ETAG_LEN 48
+
+// 파일 맨 앞 헤더 (모든 오프셋은 파일 시작 기준)
+typedef struct {
+  char magic[8]; // BUNDLE_MAGIC
+  unsigned int version;
+  unsigned int entry_count; // 엔트리 수 (= 슬롯 수)
+  unsigned int bucket_count; // 변위 테이블 크기
+  unsigned int reserved;
+  unsigned long long displacement_offset; // unsigned int[bucket_count]
+  unsigned long long entry_offset; // bundle_entry[entry_count], 슬롯 순서
+  unsigned long long file_size; // 잘린 파일 검출용
+} bundle_header;
+
+// 표현 하나 (data_length가 0이면 없는 표현, 빈 원본 파일은 present로 구분)
+typedef struct {
+  unsigned long long data_offset; // BUNDLE_ALIGN 정렬
+  unsigned long long data_length;
+  unsigned long long header_offset; // 200 헤더 블록 (Date와 빈 줄 제외)
+  unsigned int header_length;
+  unsigned int present;
+  char etag[BUNDLE_ETAG_LEN]; // 따옴표 포함
+} bundle_representation;
+
+typedef struct {
+  unsigned long long path_offset; // 키 (소문자, PATH_SEPARATOR 구분, NUL 종료)
+  unsigned int path_length;
+  unsigned int reserved;
+  long long mtime; // 원본 수정 시간
+  unsigned long long content_type_offset; // NUL 종료 문자열
+  unsigned long long last_modified_offset; // HTTP 날짜, NUL 종료
+  bundle_representation representations[ENCODING_COUNT];
+} bundle_entry;
+
+// 번들 슬롯 계산 (빌드 도구와 서버가 같은 함수 사용)
+unsigned int bundle_bucket(const char *key, size_t length, unsigned int bucket_count);
+unsigned int bundle_slot(const char *key, size_t length, unsigned int displacement, unsigned int entry_count);
+
+// 번들 열기 (0: 사용, 1: 파일 없음 - 디스크에서 제공, -1: 잘못된 번들)
+int bundle_open(const char *bundle_file);
+void bundle_close(void);
+int bundle_active(void);
+
+// 요청 경로를 번들에서 조회 (찾으면 1, result는 매핑된 뷰를 가리킴)
+// 없는 경로는 0을 돌려주고 호출자가 디스크에서 처리
+int bundle_lookup(const char *request_path, int accept_encodings, file_result *result);
+
+// 번들에 있는 경로인지 (번들이 디스크보다 먼저 조회되므로 이런 경로의 PUT/DELETE/업로드는 거부)
+int bundle_contains(const char *request_path);
+
+#endif // BUNDLE_H
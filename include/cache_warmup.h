@@ -0,0 +1,23 @@
+/*
+ * 시작 시 캐시 예열
+ * 1. 예열 목록: hot-list 파일 순서대로, 없으면 document_root를 병렬 스캔해 작은 파일부터
+ * 2. 크기 예산과 캐시 용량 안에서 데이터, 메타데이터, 압축 표현, 헤더 블록을 미리 적재
+ * 3. 모드에 따라 끝난 뒤 요청 수신 또는 백그라운드로 진행 (best-effort)
+ */
+
+#ifndef CACHE_WARMUP_H
+#define CACHE_WARMUP_H
+
+#include "config.h"
+
+#define WARMUP_OFF 0
+#define WARMUP_BLOCKING 1 // 예열이 끝난 뒤 요청 수신 시작
+#define WARMUP_BACKGROUND 2 // 요청을 받으면서 예열
+
+// 설정된 모드로 예열 시작 (BLOCKING이면 끝날 때까지 반환하지 않음)
+int cache_warmup_start(const server_config *config);
+
+// 백그라운드 예열 중단 후 종료 대기
+void cache_warmup_stop(void);
+
+#endif // CACHE_WARMUP_H
@@ -0,0 +1,27 @@
+/*
+ * 응답 본문 압축
+ * 1. gzip (zlib), br (brotli) 한 번에 압축
+ * 2. 라이브러리가 없는 빌드에서는 해당 인코딩 비활성화
+ */
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stddef.h>
+#include "file_handler.h"
+
+// 빌드에 포함된 인코딩인지
+int compress_supported(content_encoding encoding);
+
+// 압축할 가치가 있는 MIME 타입인지 (이미지, 압축 파일은 제외)
+int is_compressible_type(const char *content_type);
+
+// 압축 (성공 시 0, *out은 malloc된 버퍼로 호출자가 해제)
+// 압축 결과가 원본보다 작지 않으면 실패로 처리
+int compress_buffer(content_encoding encoding,
+                    const char *src,
+                    size_t src_len,
+                    char **out,
+                    size_t *out_len);
+
+#endif // COMPRESS_H
@@ -10,6 +10,28 @@ typedef struct {
   int max_connections; // 최대 연결 수
   int backlog_size; // 연결 대기열 크기
   char server_name[64]; // 서버 이름
+  size_t open_file_cache_max; // 열린 파일 캐시 최대 엔트리 수
+  int open_file_cache_valid; // 열린 파일 캐시 재검증 주기 (초)
+  int negative_cache_ttl; // 404/거부된 경로 캐시 유효 시간 (초, 0이면 캐시 안 함)
+  int compress_dynamic; // 사이드카가 없는 텍스트 파일 즉석 압축 여부
+  size_t compress_min_size; // 즉석 압축 최소 크기 (바이트)
+  size_t inline_max_size; // 이 크기 이하 파일은 헤더와 본문을 연속 블록으로 캐시 (바이트)
+  size_t stream_min_size; // 이 크기 이상 파일은 캐시하지 않고 블록 단위로 스트리밍 (바이트)
+  int transmit_file; // 스트리밍 대상은 TransmitFile로 커널에서 바로 전송
+  size_t slice_cache_size; // 큰 파일 Range 요청용 슬라이스 캐시 예산 (바이트, 0이면 사용 안 함)
+  int cache_mmap; // 캐시 엔트리를 파일 매핑 뷰로 유지 (복사 없이 페이지 캐시 공유)
+  size_t cache_mmap_min_size; // 매핑을 사용할 최소 크기 (바이트, stream_min_size 이상은 매핑하지 않고 스트리밍)
+  int warmup_mode; // 시작 시 캐시 예열 (0: 끔, 1: 끝난 뒤 요청 수신, 2: 백그라운드)
+  int warmup_threads; // 예열 스레드 수
+  size_t warmup_budget; // 예열할 데이터 크기 상한 (바이트)
+  char warmup_hot_list[1024]; // 우선 예열할 요청 경로 목록 (없으면 document_root 스캔)
+  char mime_types_file[1024]; // 추가 MIME 매핑 파일 (mime.types 형식, 없으면 기본 테이블만)
+  int upload_sync; // PUT 교체 전에 디스크까지 플러시 (느리지만 전원 장애에도 유지)
+  int upload_dedup; // multipart 업로드를 내용 해시 blob + 하드 링크로 저장 (같은 내용은 한 번만 기록)
+  char bundle_file[1024]; // 정적 파일 번들 (있으면 번들 경로를 디스크보다 먼저 제공)
+  char error_log_file[1024]; // 에러 로그 파일
+  size_t error_log_max_size; // 에러 로그 교체 크기 (바이트, 0이면 크기로 교체하지 않음)
+  int error_log_rotate_interval; // 에러 로그 교체 주기 (초, 0이면 시간으로 교체하지 않음)
 } server_config;
 
 // 기본 설정
@@ -8,6 +8,7 @@ typedef enum {
   DELETE_FILE_NOT_FOUND,
   DELETE_ACCESS_DENIED,
   DELETE_PATH_INVALID,
+  DELETE_BUNDLED, // 번들에서 제공되는 경로 (디스크 파일을 지워도 계속 제공됨)
   DELETE_ERROR
 } delete_result;
 
@@ -0,0 +1,20 @@
+/*
+ * 초 단위 시각 문자열 캐시
+ * 1. 스레드마다 현재 초의 HTTP Date(IMF-fixdate)와 로그 타임스탬프를 보관
+ * 2. 초가 바뀐 첫 호출에서만 포맷, 나머지는 복사만 하면 됨
+ */
+
+#ifndef DATE_CACHE_H
+#define DATE_CACHE_H
+
+#define HTTP_DATE_LEN 29 // "Sun, 06 Nov 1994 08:49:37 GMT"
+#define LOG_TIME_LEN 19 // "1994-11-06 17:49:37" (로컬 시간)
+
+// 이벤트 루프 틱마다 호출 (초가 바뀌었을 때만 다시 포맷)
+void date_cache_tick(void);
+
+// 현재 초의 문자열 (호출한 스레드 소유, 다음 초까지 유효)
+const char *http_date_now(void);
+const char *log_time_now(void);
+
+#endif // DATE_CACHE_H
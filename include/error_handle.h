@@ -31,12 +31,26 @@ typedef struct {
   int line;
 } error_context;
 
-// 에러 로깅
+// 에러 로깅 (파일과 stderr, 같은 위치의 같은 에러가 몰리면 횟수만 모아서 기록)
 void log_error(const error_context *err);
 
+// 에러 로그 파일
+// 1. 열어 둔 채 버퍼링해서 기록 (에러마다 열고 닫지 않음)
+// 2. max_size를 넘거나 rotate_interval(초, 0이면 끔)이 지나면 path.1 ~ path.N으로 밀어내고 새 파일
+// 3. error_log_reopen은 플래그만 세우고 다음 기록/틱에서 다시 열기
+//    외부 로그 교체 도구는 파일을 옮긴 뒤 이름 있는 이벤트 Local\webserver_error_log_reopen_<PID>에 SetEvent
+// error_log_open 전에 기록하면 기본 설정으로 server_error.log를 염
+int error_log_open(const char *path, size_t max_size, int rotate_interval);
+void error_log_tick(void); // 주기적으로 호출 (버퍼 플러시, 억제된 반복 요약, 시간 교체, 재열기)
+void error_log_reopen(void);
+void error_log_close(void); // 남은 요약을 기록하고 닫기 (이후에는 stderr만)
+
 // 에러 응답 생성
 void send_error_response(SOCKET client_socket, const error_context *err);
 
+// HEAD 요청용 에러 응답 (같은 헤더, 본문 제외)
+void send_error_headers(SOCKET client_socket, const error_context *err);
+
 // 에러 생성 매크로
 #define MAKE_ERROR_DETAIL(code, msg, detail) \
 ((error_context){code, msg, detail, __FILE__, __LINE__})
@@ -9,8 +9,11 @@
 #ifndef FILE_HANDLER_H
 #define FILE_HANDLER_H
 
+#include <winsock2.h>
 #include <stddef.h>
 #include <limits.h>
+#include <time.h>
+#include "path_canon.h"
 #ifndef PATH_MAX
 #define PATH_MAX 4096
 #endif
@@ -18,54 +21,142 @@
 #include <stdlib.h>  // for _fullpath
 #endif
 
-// MIME 타입 매핑
-typedef struct {
-  const char *extension;
-  const char *mime_type;
-} mime_mapping;
+#define CACHE_SHARD_COUNT 16 // 캐시 샤드 수 (2의 거듭제곱)
+
+// 응답 본문 인코딩 (표현)
+typedef enum {
+  ENCODING_IDENTITY = 0,
+  ENCODING_GZIP,
+  ENCODING_BR,
+  ENCODING_COUNT
+} content_encoding;
+
+// 즉석 압축 표현 (size가 0이면 압축 이득이 없어 원본 사용)
+typedef struct cache_variant {
+  size_t size; // 압축된 크기
+  char data[]; // 압축된 데이터
+} cache_variant;
+
+// 미리 만든 200 응답 헤더 블록 (상태 줄부터, Date와 마지막 빈 줄 제외)
+typedef struct cache_header {
+  int varies; // 만들 때의 Vary 여부 (달라지면 사용하지 않음)
+  size_t length; // 블록 길이
+  char data[]; // 헤더 텍스트
+} cache_header;
+
+typedef struct cache_entry {
+  char *data; // 파일 데이터
+  size_t size; // 파일 크기
+  int mapped; // data가 파일 매핑 뷰 (해제 시 UnmapViewOfFile)
+  const char *content_type; // Content-Type (인턴된 문자열)
+  time_t last_modified; // 파일 마지막 수정 시간
+  time_t cached_time; // 캐시된 시간
+  volatile LONG ref_count; // 참조 카운터 (캐시 보유분 1 + 사용 중인 요청 수)
+  cache_variant *volatile variants[ENCODING_COUNT]; // 인코딩별 즉석 압축 결과 (엔트리와 함께 무효화)
+  cache_header *volatile headers[ENCODING_COUNT]; // 인코딩별 200 응답 헤더 블록
+  cache_header *volatile inline_responses[ENCODING_COUNT]; // 작은 파일의 헤더 + 본문 연속 블록
+  char *path; // 캐시 키 (정규화된 전체 경로)
+  unsigned int hash; // 경로 해시
+  struct cache_entry *hash_next; // 버킷 체인
+  struct cache_entry *lru_prev; // LRU 리스트 (head가 최근 사용)
+  struct cache_entry *lru_next;
+} cache_entry;
+
+struct open_file;
 
 // 파일 처리 결과
 typedef struct {
   char *data; // 파일 데이터
   size_t size; // 파일 크기
-  char *content_type; // MIME 타입
+  const char *content_type; // Content-Type (인턴된 문자열)
   int status_code; // HTTP 상태 코드
   const char* error_detail; // 에러 상세 내용
+  cache_entry *cache_ref; // 캐시에서 빌려온 경우 해당 엔트리 (data 소유자)
+  struct open_file *file_ref; // 열린 파일 캐시 엔트리 (크기, 수정 시간 등 메타데이터)
+  int negative_hit; // 부정 캐시에서 찾은 에러 (로그 생략)
+  content_encoding encoding; // 본문 인코딩 (Content-Encoding)
+  int varies; // Accept-Encoding에 따라 표현이 달라짐 (Vary 필요)
+  int dynamic; // encoding이 즉석 압축 표현 (디스크와 캐시에는 원본, 읽기 전 size는 원본 크기)
+  char etag[64]; // 표현의 ETag (따옴표 포함)
+  int mapped; // data가 파일 매핑 뷰
+  const char *last_modified; // Last-Modified 값 (HTTP 날짜)
+  time_t mtime; // 마지막 수정 시간 (If-Modified-Since 비교용)
+  int from_bundle; // data가 번들 매핑을 가리킴 (해제하지 않음)
+  const char *header_block; // 미리 만든 200 헤더 블록 (번들), 없으면 NULL
+  size_t header_length;
 } file_result;
 
+// 락 단위로 분리된 캐시 샤드
 typedef struct {
-  char *data; // 파일 데이터
-  size_t size; // 파일 크기
-  char *content_type; // MIME 타입
-  time_t last_modified; // 파일 마지막 수정 시간
-  time_t cached_time; // 캐시된 시간
-  size_t ref_count; // 참조 카운터
-} cache_entry;
+  SRWLOCK lock; // 샤드 락
+  cache_entry **buckets; // 해시 버킷
+  size_t bucket_count; // 버킷 수 (2의 거듭제곱)
+  cache_entry *lru_head; // 가장 최근 사용
+  cache_entry *lru_tail; // 가장 오래 전 사용 (제거 대상)
+  size_t size; // 현재 캐시된 파일 수
+  size_t capacity; // 샤드별 최대 캐시 크기
+} cache_shard;
 
 typedef struct {
-  cache_entry **entries; // 캐시 엔트리 배열
-  char **paths; // 캐시된 파일 경로 배열
-  size_t size; // 현재 캐시된 파일 수
-  size_t capacity; // 최대 캐시 크기
+  cache_shard shards[CACHE_SHARD_COUNT];
 } file_cache;
 
-// 파일 읽기
-file_result read_file(const char *base_path, const char *request_path);
+// 파일 읽기 (accept_encodings: ACCEPT_ENCODING_* 비트, 가능한 압축 표현 선택)
+file_result read_file(const char *base_path, const char *request_path, int accept_encodings);
+
+// 조건부 요청용 2단계 읽기
+// 1. lookup_file: 메타데이터와 ETag만 준비 (캐시 히트면 data도 채움, 디스크 읽기 없음)
+// 2. load_file_data: data가 없으면 디스크에서 읽고 캐시에 저장
+//    (즉석 압축 이득이 없으면 원본 표현으로 바뀌며 ETag 갱신)
+file_result lookup_file(const char *base_path, const char *request_path, int accept_encodings);
+int load_file_data(file_result *result);
+
+// Content-Encoding 토큰, 사이드카 파일 확장자
+const char *encoding_name(content_encoding encoding);
+const char *encoding_suffix(content_encoding encoding);
 
 // 리소스 정리
 void free_file_result(file_result *result);
 
-// MIME 타입 감지
-const char *get_mime_type(const char *file_path);
 
 // 보안용 경로 검증
 int is_path_safe(const char *path);
 
+// document_root 디렉토리 핸들 (시작 시 한 번 열고 종료 시 닫기)
+int docroot_init(const char *document_root);
+void docroot_cleanup(void);
+
+// 열린 파일이 document_root 아래에 있는지 검사
+int docroot_contains(HANDLE file);
+
+// 요청 경로를 검증하고 정규화된 전체 경로 생성 (성공 시 200, 거부 시 403)
+int resolve_request_path(const char *base_path, const char *request_path, char *out, size_t out_size);
+
 // 캐시 관련 함수들
+// cache_get이 돌려준 엔트리는 사용 후 반드시 cache_release로 반납
+// 캐시에서 제거되어도 마지막 참조가 반납될 때까지 data는 유효
 void cache_init(size_t capacity);
 void cache_cleanup(void);
+size_t cache_capacity(void); // 전체 최대 엔트리 수
+void cache_print_stats(void); // 동시 미스 합류 횟수 등
 cache_entry *cache_get(const char *path);
-void cache_put(const char *path, const file_result *result);
+cache_entry *cache_put(const char *path, const file_result *result); // 성공 시 data 소유권을 넘겨받고 참조 획득 상태로 반환
 void cache_remove(const char *path);
+void cache_release(cache_entry *entry);
+
+// 엔트리의 압축 표현 (처음 요청 시 한 번 압축, 이득이 없으면 NULL)
+const cache_variant *cache_get_variant(cache_entry *entry, content_encoding encoding);
+
+// 결과 표현의 200 응답 헤더 블록 (처음 요청 시 한 번 생성, 캐시되지 않은 결과면 NULL)
+const cache_header *cache_get_header(cache_entry *entry, const file_result *result);
+
+// 작은 파일의 인라인 응답 (상태 줄 다음 헤더부터 빈 줄, 본문까지 연속, 상태 줄과 Date는 앞에 붙여 전송)
+// max_size보다 큰 표현이나 캐시되지 않은 결과면 NULL
+const cache_header *cache_get_inline_response(cache_entry *entry, const file_result *result, size_t max_size);
+
+// 파일 변경 감지 시 무효화 (진행 중인 읽기 결과가 캐시에 들어가지 않도록 세대 증가)
+void cache_invalidate(const char *path);
+void cache_invalidate_prefix(const char *dir_path);
+void cache_clear(void);
 
 #endif // FILE_HANDLER_H
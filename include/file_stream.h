@@ -0,0 +1,50 @@
+/*
+ * 대용량 파일 스트리밍 읽기
+ * 1. 열린 파일 핸들을 순차 읽기 + 비동기(overlapped) 모드로 다시 열기
+ * 2. 고정 크기 블록 몇 개를 미리 읽어 두고 전송과 디스크 읽기를 겹침
+ * 3. 전송당 메모리는 STREAM_DEPTH * STREAM_BLOCK_SIZE로 제한 (블록은 풀에서 재사용)
+ * 4. 커널 전송 모드는 TransmitFile로 파일에서 소켓으로 복사 없이 전송
+ */
+
+#ifndef FILE_STREAM_H
+#define FILE_STREAM_H
+
+#include <winsock2.h>
+#include "file_handler.h"
+
+#define STREAM_BLOCK_SIZE (256 * 1024) // 블록 크기
+#define STREAM_DEPTH 4 // 미리 읽는 블록 수
+#define STREAM_POOL_MAX 64 // 재사용을 위해 보관하는 최대 블록 수
+#define TRANSMIT_CHUNK_MAX (1024UL * 1024 * 1024) // TransmitFile 한 번에 보내는 최대 크기
+
+typedef struct file_stream file_stream;
+
+// [offset, offset + length) 구간 스트림 열기 (실패 시 NULL)
+file_stream *file_stream_open(const struct open_file *file,
+                              content_encoding encoding,
+                              unsigned long long offset,
+                              unsigned long long length);
+
+// 다음 블록 (읽기 완료까지 대기), 끝이나 에러면 NULL
+// 반환된 블록은 다음 호출이나 file_stream_close 전까지 유효
+const char *file_stream_next(file_stream *stream, size_t *length);
+
+// 커널 전송용 스트림 (미리 읽기 블록 없이 핸들만 준비, 실패 시 NULL)
+file_stream *file_stream_open_transmit(const struct open_file *file,
+                                       content_encoding encoding,
+                                       unsigned long long offset,
+                                       unsigned long long length);
+
+// 구간 전체를 TransmitFile로 소켓에 바로 전송 (성공 시 0)
+int file_stream_transmit(file_stream *stream, SOCKET socket);
+
+// 읽기 에러가 있었는지
+int file_stream_failed(const file_stream *stream);
+
+// 진행 중인 읽기 취소, 블록 반납
+void file_stream_close(file_stream *stream);
+
+// 풀에 보관된 블록 해제 (종료 시)
+void file_stream_pool_cleanup(void);
+
+#endif // FILE_STREAM_H
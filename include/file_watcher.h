@@ -0,0 +1,19 @@
+/*
+ * 파일 변경 감시
+ * 1. document_root 하위 변경 감지 (ReadDirectoryChangesW)
+ * 2. 수정/이동/삭제된 파일의 캐시 엔트리 무효화
+ */
+
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+// 감시 스레드 시작 (성공 시 0)
+int file_watcher_start(const char *root_path);
+
+// 감시 스레드 중지
+void file_watcher_stop(void);
+
+// 감시 중인지 여부 (감시 중이면 캐시 히트 시 stat 생략)
+int file_watcher_active(void);
+
+#endif // FILE_WATCHER_H
@@ -0,0 +1,14 @@
+/*
+ * 빠른 비암호화 해시
+ * - 64비트 xxHash (4개 레인으로 32바이트씩 처리)
+ * - 번들 인덱스, 에러 로그 제한 키 계산용
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+
+unsigned long long hash64(const void *data, size_t length, unsigned long long seed);
+
+#endif // HASH_H
@@ -13,6 +13,11 @@
 #define MAX_QUERY_PARAMS 20
 #define MAX_POST_PARAMS 20
 #include <stddef.h>
+#include <time.h>
+
+// Accept-Encoding에서 허용된 인코딩 비트
+#define ACCEPT_ENCODING_GZIP 0x01
+#define ACCEPT_ENCODING_BR 0x02
 
 // HTTP 메소드
 typedef enum {
@@ -100,7 +105,7 @@ typedef struct {
   http_parameter post_params[MAX_POST_PARAMS];
   int post_param_count;
   char content_type[256];
-  long content_length;
+  long long content_length;
 
   // 자주 쓰는 헤더
   char host[256];
@@ -132,6 +137,13 @@ const char *get_header_value(const http_request *request, const char *header_nam
 const char *get_query_param(const http_request *request, const char *param_name);
 const char *get_post_param(const http_request *request, const char *param_name);
 content_type_t parse_content_type(const char *content_type);
+int parse_accept_encoding(const char *accept_encoding);
+
+// If-None-Match 목록에 etag가 있는지 (약한 비교, "*"는 항상 일치)
+int etag_list_matches(const char *if_none_match, const char *etag);
+
+// HTTP 날짜 파싱 (IMF-fixdate, RFC 850, asctime), 실패 시 -1
+time_t parse_http_date(const char *value);
 int parse_json_body(http_request *req, const char *body);
 int parse_multipart_body(http_request *req, const char *body, const char *boundary);
 void free_request_body(http_request *req);
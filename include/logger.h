@@ -0,0 +1,47 @@
+/*
+ * 비동기 로그
+ * 1. 레벨별 매크로 (LOG_LEVEL보다 낮은 레벨은 컴파일 시 제거)
+ * 2. 스레드마다 고정 크기 레코드 링 버퍼에 기록 (락 없음, 가득 차면 버리고 개수만 집계)
+ * 3. 백그라운드 스레드가 링을 모아 한 번에 stdout으로 출력
+ * 4. logger_init 전이나 logger_shutdown 후에는 바로 출력
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#define LOG_LEVEL_DEBUG 0 // 요청마다 찍히는 상세 로그
+#define LOG_LEVEL_INFO 1 // 요청 단위 요약
+#define LOG_LEVEL_WARN 2 // 서비스는 계속되는 이상 상황
+#define LOG_LEVEL_OFF 3
+
+// 컴파일 시 로그 레벨 (-DLOG_LEVEL=... 로 변경, 기본: 디버그 빌드는 DEBUG, 릴리스는 INFO)
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#define LOG_RECORD_TEXT 240 // 레코드당 메시지 길이 (넘으면 잘림)
+#define LOG_RING_SIZE 512 // 스레드별 링 레코드 수 (2의 거듭제곱)
+
+// 꺼진 레벨은 if (0)으로 남겨 인자 검사만 하고 코드는 생성하지 않음
+#define LOG_AT(level, ...) \
+  do { if ((level) >= LOG_LEVEL) log_write((level), __VA_ARGS__); } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+
+// 출력 스레드 시작 / 남은 레코드를 모두 출력하고 종료 (성공 시 0)
+int logger_init(void);
+void logger_shutdown(void);
+
+// 레코드 기록 (매크로를 통해 호출)
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void log_write(int level, const char *format, ...);
+
+#endif // LOGGER_H
@@ -0,0 +1,18 @@
+/*
+ * 확장자 -> Content-Type 매핑
+ * 1. 시작 시 기본 테이블과 mime.types 형식 파일로 해시 테이블 생성
+ * 2. charset까지 붙인 Content-Type 문자열을 한 번만 만들어 공유 (해제 불필요)
+ * 3. 생성 후에는 읽기 전용이라 락 없이 조회
+ */
+
+#ifndef MIME_TYPES_H
+#define MIME_TYPES_H
+
+// 테이블 생성 (mime_types_file이 없거나 비어 있으면 기본 테이블만 사용)
+int mime_types_init(const char *mime_types_file);
+void mime_types_cleanup(void);
+
+// 파일 경로의 Content-Type (알 수 없으면 application/octet-stream)
+const char *get_mime_type(const char *file_path);
+
+#endif // MIME_TYPES_H
@@ -0,0 +1,79 @@
+/*
+ * 열린 파일 핸들 및 메타데이터 캐시
+ * 1. 요청 경로별 파일 핸들, 크기, 수정 시간, 파일 ID 보관
+ * 2. Last-Modified용 HTTP 날짜 문자열 미리 생성
+ * 3. 404/거부된 경로는 부정 캐시로 짧은 TTL 동안 보관 (PUT/업로드 시 무효화)
+ */
+
+#ifndef OPEN_FILE_CACHE_H
+#define OPEN_FILE_CACHE_H
+
+#include <winsock2.h>
+#include <stddef.h>
+#include <time.h>
+#include "file_handler.h"
+
+// 미리 압축된 사이드카 파일 (file.ext.gz, file.ext.br)
+typedef struct {
+  HANDLE handle; // 없으면 INVALID_HANDLE_VALUE
+  unsigned long long size; // 압축된 크기
+} file_variant;
+
+typedef struct open_file {
+  char request_path[PATH_MAX]; // 캐시 키 (요청 경로, 넘치는 경로는 캐시하지 않음)
+  char path[PATH_MAX]; // 정규화된 전체 경로
+  HANDLE handle; // 열린 파일 핸들 (에러 엔트리는 INVALID_HANDLE_VALUE)
+  unsigned long long size; // 파일 크기
+  time_t mtime; // 마지막 수정 시간
+  unsigned long long mtime_ticks; // 마지막 수정 시간 (FILETIME 100ns 단위, ETag와 슬라이스 키용)
+  unsigned long long file_id; // 볼륨 일련번호 + 파일 인덱스 (inode 대응)
+  char http_date[32]; // Last-Modified 헤더 값
+  file_variant variants[ENCODING_COUNT]; // 인코딩별 사이드카 (ENCODING_IDENTITY 칸은 사용 안 함)
+  int has_variants; // 사이드카가 하나라도 있으면 Vary 필요
+  int status_code; // 200 또는 캐시된 에러 상태 코드
+  time_t validated; // 열거나 검증한 시각
+  volatile LONG ref_count; // 참조 카운터 (캐시 보유분 1 + 사용 중인 요청 수)
+  unsigned int hash; // 키 해시
+  struct open_file *hash_next; // 버킷 체인
+  struct open_file *lru_prev; // LRU 리스트 (head가 최근 사용)
+  struct open_file *lru_next;
+} open_file;
+
+// 캐시 초기화 (max_entries: 최대 엔트리 수, valid_seconds: 재검증 주기, negative_ttl: 에러 결과 TTL, 0이면 캐시 안 함)
+void open_file_cache_init(size_t max_entries, int valid_seconds, int negative_ttl);
+
+// 캐시 정리
+void open_file_cache_cleanup(void);
+
+// 요청 경로로 열린 파일 조회, 없으면 경로 검증 후 열어서 캐시 (항상 참조 획득 상태로 반환)
+// 반환값이 NULL이면 메모리 부족, status_code가 200이 아니면 에러 엔트리
+// cache_hit에는 캐시에서 찾았는지 여부 저장 (NULL 가능)
+open_file *open_file_cache_get(const char *base_path, const char *request_path, int *cache_hit);
+
+// 참조 반납
+void open_file_release(open_file *file);
+
+// 전체 경로가 같은 엔트리 무효화 (파일 변경, 삭제, 덮어쓰기 전)
+void open_file_cache_invalidate(const char *full_path);
+
+// 요청 경로 키로 무효화 (PUT 등으로 새로 생긴 경로의 부정 캐시 제거)
+void open_file_cache_invalidate_request(const char *request_path);
+
+// 전체 무효화
+void open_file_cache_clear(void);
+
+// 지정 위치에서 읽기 (공유 핸들이므로 파일 포인터를 쓰지 않음)
+size_t open_file_read(const open_file *file,
+                      content_encoding encoding,
+                      void *buffer,
+                      size_t length,
+                      unsigned long long offset);
+
+// 인코딩 표현이 있는지, 크기
+int open_file_has_variant(const open_file *file, content_encoding encoding);
+unsigned long long open_file_size(const open_file *file, content_encoding encoding);
+
+// 읽기 전용 매핑 뷰 (미리 읽기 요청 포함, 실패 시 NULL, UnmapViewOfFile로 해제)
+void *open_file_map(const open_file *file, content_encoding encoding, size_t length);
+
+#endif // OPEN_FILE_CACHE_H
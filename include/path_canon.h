@@ -0,0 +1,27 @@
+/*
+ * 요청 경로 정규화
+ * 1. 퍼센트 디코딩, 구분자 정리, 점 세그먼트 처리를 한 번의 순회로
+ * 2. 인코딩된 NUL/구분자, 이중 인코딩, 제어 문자, 숨김 컴포넌트 거부
+ * 3. 파일 시스템에 접근하지 않음 (도구에서도 그대로 링크)
+ */
+
+#ifndef PATH_CANON_H
+#define PATH_CANON_H
+
+#include <stddef.h>
+
+// 경로 정규화 결과
+typedef enum {
+  PATH_OK = 0,
+  PATH_EMPTY, // 빈 경로
+  PATH_TOO_LONG, // 버퍼 초과
+  PATH_BAD_ENCODING, // 잘못된/이중 인코딩, %u 인코딩, overlong UTF-8
+  PATH_BAD_CHAR, // NUL, 제어 문자, 인코딩된 구분자, ':'
+  PATH_TRAVERSAL, // 루트 위로 올라가는 ".."
+  PATH_HIDDEN // '.'으로 시작하거나 '.'/공백으로 끝나는 컴포넌트
+} path_status;
+
+// 요청 경로를 한 번에 디코딩, 정규화 (out: document_root 기준 상대 경로)
+path_status canonicalize_path(const char *path, char *out, size_t out_size);
+
+#endif // PATH_CANON_H
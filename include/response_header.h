@@ -0,0 +1,24 @@
+/*
+ * 200 응답 헤더 블록 생성
+ * - 캐시 엔트리, 번들 빌드 도구, 캐시되지 않은 응답이 같은 형식을 사용
+ * - 상태 줄부터 마지막 헤더까지 (Date와 빈 줄은 전송 시 붙임)
+ */
+
+#ifndef RESPONSE_HEADER_H
+#define RESPONSE_HEADER_H
+
+#include <stddef.h>
+
+#define STATUS_LINE_200 "HTTP/1.1 200 OK\r\n" // 헤더 블록의 첫 줄
+
+// content_encoding이 NULL이면 원본 표현, 성공 시 길이, 버퍼 부족 시 -1
+int format_header_block(char *out,
+                        size_t out_size,
+                        const char *content_type,
+                        unsigned long long content_length,
+                        const char *content_encoding,
+                        int varies,
+                        const char *etag,
+                        const char *last_modified);
+
+#endif // RESPONSE_HEADER_H
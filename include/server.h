@@ -55,6 +55,9 @@ void optimize_socket(SOCKET socket);
 // Range 헤더 파싱
 range_request* parse_range_header(const char* range_header, size_t file_size);
 
+// 크기 계층별 응답 수 출력
+void server_print_stats(void);
+
 // 정적 파일 처리 (Range 요청 지원)
 void handle_static_file(SOCKET client_socket, const http_request* req, const char* request_path);
 
@@ -0,0 +1,32 @@
+/*
+ * 대용량 파일 구간(슬라이스) 캐시
+ * 1. 파일을 SLICE_SIZE 단위로 나눈 정렬된 구간을 (파일 ID, 수정 시간, 크기, 인코딩, 번호) 키로 보관
+ * 2. 전체 캐시와 별도의 바이트 예산, 초과 시 LRU 제거
+ * 3. 큰 파일의 Range 요청을 캐시된 슬라이스와 없는 슬라이스의 디스크 읽기로 조립
+ */
+
+#ifndef SLICE_CACHE_H
+#define SLICE_CACHE_H
+
+#include <winsock2.h>
+#include <stddef.h>
+#include "file_handler.h"
+
+#define SLICE_SIZE (1024 * 1024) // 슬라이스 크기 (STREAM_BLOCK_SIZE의 배수)
+
+typedef struct slice_entry slice_entry;
+
+// 캐시 생성 (budget: 슬라이스 데이터 최대 바이트, 0이면 사용 안 함)
+int slice_cache_init(size_t budget);
+void slice_cache_cleanup(void);
+int slice_cache_enabled(void);
+void slice_cache_print_stats(void);
+
+// index번째 슬라이스 (없으면 디스크에서 읽어 캐시, 참조 획득 상태로 반환, 실패 시 NULL)
+slice_entry *slice_cache_get(const struct open_file *file, content_encoding encoding, unsigned long long index);
+void slice_cache_release(slice_entry *slice);
+
+// 슬라이스 데이터 (파일의 index * SLICE_SIZE 위치부터, 마지막 슬라이스는 짧음)
+const char *slice_data(const slice_entry *slice, size_t *length);
+
+#endif // SLICE_CACHE_H
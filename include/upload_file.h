@@ -0,0 +1,32 @@
+/*
+ * 업로드 파일 쓰기
+ * 1. 대상과 같은 디렉토리의 임시 파일에 받은 순서대로 기록 (요청 본문 전체를 메모리에 두지 않음)
+ * 2. Content-Length만큼 미리 공간 할당
+ * 3. 다 받으면 (설정 시 디스크까지 플러시 후) 대상 이름으로 원자적으로 교체
+ *    - 읽는 쪽은 이전 내용이나 새 내용 전체만 봄
+ */
+
+#ifndef UPLOAD_FILE_H
+#define UPLOAD_FILE_H
+
+#include <stddef.h>
+
+typedef struct upload_file upload_file;
+
+// 임시 파일 생성 (expected_size: 미리 할당할 크기, 실패 시 NULL)
+upload_file *upload_begin(const char *target_path, unsigned long long expected_size);
+
+// 이어서 기록 (성공 시 0)
+int upload_write(upload_file *upload, const void *data, size_t length);
+
+// 기록한 바이트 수
+unsigned long long upload_size(const upload_file *upload);
+
+// 대상 이름으로 교체 (sync: 교체 전 FlushFileBuffers, 성공 시 0)
+// 성공 여부와 관계없이 upload는 해제됨 (실패 시 임시 파일 삭제)
+int upload_commit(upload_file *upload, int sync);
+
+// 취소 (임시 파일 삭제)
+void upload_abort(upload_file *upload);
+
+#endif // UPLOAD_FILE_H
@@ -0,0 +1,191 @@
+/*
+ * 내용 주소 기반 업로드 저장소
+ * - blob 이름은 SHA-256 16진수 (BCrypt, 알고리즘 핸들은 한 번만 열어 공유)
+ * - blob_dir 이름은 '.'으로 시작해 경로 검사에서 숨김으로 거부되므로 blob은 직접 제공되지 않음
+ * - 이름 교체: 같은 디렉토리에 임시 링크를 만든 뒤 MoveFileEx로 덮어씀
+ *   (이전 내용의 blob은 링크 수만 줄어듦)
+ * - 하드 링크라 blob_dir과 업로드 폴더는 같은 볼륨이어야 함
+ * - 불변 조건: 업로드 이름은 교체만 하고 제자리에서 다시 쓰지 않음
+ *   (이름이 blob에 링크되어 있으면 제자리 쓰기가 blob과 같은 내용의 다른 이름까지 바꿈,
+ *    중복 제거를 끈 뒤의 업로드, PUT도 upload_begin/upload_commit으로 임시 파일을 교체)
+ */
+
+#include "blob_store.h"
+#include "file_handler.h"
+#include "upload_file.h"
+#include <windows.h>
+#include <bcrypt.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+#define BLOB_HASH_SIZE 32 // SHA-256
+#define BLOB_HASH_CHUNK (1024 * 1024) // BCryptHashData 한 번에 넘기는 크기
+
+static BCRYPT_ALG_HANDLE sha256 = NULL;
+static char blob_root[PATH_MAX];
+
+// 지표
+static volatile LONG blobs_written = 0; // 새로 저장한 blob 수
+static volatile LONG blobs_reused = 0; // 디스크 쓰기 없이 링크만 만든 업로드 수
+static volatile LONGLONG bytes_saved = 0; // 중복 제거로 생략한 쓰기 바이트
+static volatile LONG link_counter = 0; // 임시 링크 이름 구분용
+
+// 링크 수 (열기 실패 시 0)
+static DWORD link_count(const char *path) {
+  HANDLE handle = CreateFileA(path, FILE_READ_ATTRIBUTES,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (handle == INVALID_HANDLE_VALUE) return 0;
+
+  BY_HANDLE_FILE_INFORMATION info;
+  DWORD links = GetFileInformationByHandle(handle, &info) ? info.nNumberOfLinks : 0;
+  CloseHandle(handle);
+  return links;
+}
+
+// 어떤 업로드 이름도 가리키지 않는 blob, 중단된 임시 파일 삭제
+static void collect_garbage(void) {
+  char pattern[PATH_MAX];
+  snprintf(pattern, sizeof(pattern), "%s%c*", blob_root, PATH_SEPARATOR);
+
+  WIN32_FIND_DATAA find_data;
+  HANDLE find = FindFirstFileA(pattern, &find_data);
+  if (find == INVALID_HANDLE_VALUE) return;
+
+  int removed = 0;
+  do {
+    if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s%c%s", blob_root, PATH_SEPARATOR, find_data.cFileName);
+    if (find_data.cFileName[0] == '.' || link_count(path) == 1) {
+      if (DeleteFileA(path)) removed++;
+    }
+  } while (FindNextFileA(find, &find_data));
+  FindClose(find);
+
+  if (removed > 0) printf("Blob store: removed %d unreferenced files\n", removed);
+}
+
+int blob_store_init(const char *blob_dir) {
+  if (strlen(blob_dir) >= sizeof(blob_root)) return -1;
+  strcpy(blob_root, blob_dir);
+
+  // 업로드 폴더와 blob 폴더 생성 (이미 있으면 그대로)
+  char parent[PATH_MAX];
+  strcpy(parent, blob_root);
+  char *separator = strrchr(parent, PATH_SEPARATOR);
+  if (separator) {
+    *separator = '\0';
+    CreateDirectoryA(parent, NULL);
+  }
+  if (!CreateDirectoryA(blob_root, NULL) && GetLastError() != ERROR_ALREADY_EXISTS) {
+    return -1;
+  }
+
+  if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&sha256, BCRYPT_SHA256_ALGORITHM, NULL, 0))) {
+    sha256 = NULL;
+    return -1;
+  }
+
+  collect_garbage();
+  return 0;
+}
+
+void blob_store_cleanup(void) {
+  if (sha256) BCryptCloseAlgorithmProvider(sha256, 0);
+  sha256 = NULL;
+}
+
+int blob_store_enabled(void) {
+  return sha256 != NULL;
+}
+
+void blob_store_print_stats(void) {
+  if (!sha256) return;
+  printf("Blob Store: %ld written, %ld deduplicated (%lld bytes saved)\n",
+         (long) blobs_written, (long) blobs_reused, (long long) bytes_saved);
+}
+
+// SHA-256 16진수 (성공 시 0)
+static int hash_hex(const void *data, size_t length, char *out) {
+  BCRYPT_HASH_HANDLE hash = NULL;
+  unsigned char digest[BLOB_HASH_SIZE];
+  if (!BCRYPT_SUCCESS(BCryptCreateHash(sha256, &hash, NULL, 0, NULL, 0, 0))) return -1;
+
+  int ok = 1;
+  const unsigned char *position = (const unsigned char *) data;
+  while (ok && length > 0) {
+    ULONG chunk = (ULONG) (length < BLOB_HASH_CHUNK ? length : BLOB_HASH_CHUNK);
+    ok = BCRYPT_SUCCESS(BCryptHashData(hash, (unsigned char *) position, chunk, 0));
+    position += chunk;
+    length -= chunk;
+  }
+  if (ok) ok = BCRYPT_SUCCESS(BCryptFinishHash(hash, digest, sizeof(digest), 0));
+  BCryptDestroyHash(hash);
+  if (!ok) return -1;
+
+  for (int i = 0; i < BLOB_HASH_SIZE; i++) {
+    sprintf(out + i * 2, "%02x", digest[i]);
+  }
+  return 0;
+}
+
+// 대상 디렉토리에 임시 링크를 만들고 대상 이름으로 교체
+static int link_blob(const char *blob_path, const char *target_path) {
+  char temp_path[PATH_MAX];
+  const char *name = strrchr(target_path, PATH_SEPARATOR);
+  size_t dir_length = name ? (size_t) (name - target_path) + 1 : 0;
+  snprintf(temp_path, sizeof(temp_path), "%.*s.link-%lu-%ld.tmp",
+           (int) dir_length, target_path,
+           GetCurrentProcessId(), InterlockedIncrement(&link_counter));
+
+  if (!CreateHardLinkA(temp_path, blob_path, NULL)) return -1;
+  if (!MoveFileExA(temp_path, target_path, MOVEFILE_REPLACE_EXISTING)) {
+    DeleteFileA(temp_path);
+    return -1;
+  }
+  return 0;
+}
+
+int blob_store_put(const char *target_path, const void *data, size_t length, int sync, int *deduplicated) {
+  if (deduplicated) *deduplicated = 0;
+  if (!sha256) return -1;
+
+  char hex[BLOB_HASH_SIZE * 2 + 1];
+  if (hash_hex(data, length, hex) != 0) return -1;
+
+  char blob_path[PATH_MAX];
+  snprintf(blob_path, sizeof(blob_path), "%s%c%s", blob_root, PATH_SEPARATOR, hex);
+
+  // 같은 내용이 이미 있으면 쓰기 생략
+  struct stat st;
+  int reused = stat(blob_path, &st) == 0;
+  if (!reused) {
+    upload_file *upload = upload_begin(blob_path, length);
+    if (!upload) return -1;
+    if (upload_write(upload, data, length) != 0) {
+      upload_abort(upload);
+      return -1;
+    }
+    // 같은 내용을 동시에 저장했으면 같은 바이트로 덮어씀
+    if (upload_commit(upload, sync) != 0) return -1;
+    InterlockedIncrement(&blobs_written);
+  }
+
+  if (link_blob(blob_path, target_path) != 0) return -1;
+
+  if (reused) {
+    InterlockedIncrement(&blobs_reused);
+    InterlockedExchangeAdd64(&bytes_saved, (LONGLONG) length);
+    if (deduplicated) *deduplicated = 1;
+  }
+  return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * 정적 파일 번들
+ * - 파일 전체를 읽기 전용 매핑 하나로 유지 (시작 비용은 파일 수와 무관)
+ * - 조회: 버킷 해시 -> 변위 -> 슬롯 해시 -> 키 비교
+ * - 번들은 서버 시작 전에 열고 종료 후 닫으므로 조회에 락이 필요 없음
+ */
+
+#include "bundle.h"
+#include "hash.h"
+#include "http_parser.h"
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+static HANDLE bundle_handle = INVALID_HANDLE_VALUE;
+static HANDLE bundle_mapping = NULL;
+static const char *bundle_view = NULL;
+static const bundle_header *bundle = NULL;
+static const unsigned int *displacements = NULL;
+static const bundle_entry *entries = NULL;
+
+unsigned int bundle_bucket(const char *key, size_t length, unsigned int bucket_count) {
+  return (unsigned int) (hash64(key, length, 0) % bucket_count);
+}
+
+unsigned int bundle_slot(const char *key, size_t length, unsigned int displacement, unsigned int entry_count) {
+  return (unsigned int) (hash64(key, length, displacement) % entry_count);
+}
+
+// 오프셋 범위 검사 (잘못 만든 번들이 매핑 밖을 가리키지 않도록)
+static int in_bundle(unsigned long long offset, unsigned long long length) {
+  return offset <= bundle->file_size && length <= bundle->file_size - offset;
+}
+
+// NUL 종료 문자열이 번들 안에 있는지
+static const char *bundle_string(unsigned long long offset) {
+  if (offset >= bundle->file_size) return NULL;
+  if (!memchr(bundle_view + offset, '\0', (size_t) (bundle->file_size - offset))) return NULL;
+  return bundle_view + offset;
+}
+
+int bundle_open(const char *bundle_file) {
+  bundle_handle = CreateFileA(bundle_file, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (bundle_handle == INVALID_HANDLE_VALUE) {
+    DWORD error = GetLastError();
+    return error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND ? 1 : -1;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(bundle_handle, &size) || (unsigned long long) size.QuadPart < sizeof(bundle_header)) {
+    bundle_close();
+    return -1;
+  }
+
+  bundle_mapping = CreateFileMappingA(bundle_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (bundle_mapping) {
+    bundle_view = (const char *) MapViewOfFile(bundle_mapping, FILE_MAP_READ, 0, 0, 0);
+  }
+  if (!bundle_view) {
+    bundle_close();
+    return -1;
+  }
+
+  // 헤더와 테이블 위치만 검사 (엔트리 내용은 조회 시 검사)
+  bundle = (const bundle_header *) bundle_view;
+  unsigned long long file_size = (unsigned long long) size.QuadPart;
+  if (memcmp(bundle->magic, BUNDLE_MAGIC, sizeof(bundle->magic)) != 0 ||
+      bundle->version != BUNDLE_VERSION ||
+      bundle->file_size != file_size ||
+      (bundle->entry_count > 0 && bundle->bucket_count == 0) ||
+      !in_bundle(bundle->displacement_offset, (unsigned long long) bundle->bucket_count * sizeof(unsigned int)) ||
+      !in_bundle(bundle->entry_offset, (unsigned long long) bundle->entry_count * sizeof(bundle_entry)) ||
+      bundle->displacement_offset % sizeof(unsigned int) != 0 ||
+      bundle->entry_offset % sizeof(unsigned long long) != 0) {
+    bundle_close();
+    return -1;
+  }
+
+  displacements = (const unsigned int *) (bundle_view + bundle->displacement_offset);
+  entries = (const bundle_entry *) (bundle_view + bundle->entry_offset);
+
+  printf("Bundle opened: %s (%u entries, %llu bytes)\n",
+         bundle_file, bundle->entry_count, bundle->file_size);
+  return 0;
+}
+
+void bundle_close(void) {
+  if (bundle_view) UnmapViewOfFile(bundle_view);
+  if (bundle_mapping) CloseHandle(bundle_mapping);
+  if (bundle_handle != INVALID_HANDLE_VALUE) CloseHandle(bundle_handle);
+
+  bundle_handle = INVALID_HANDLE_VALUE;
+  bundle_mapping = NULL;
+  bundle_view = NULL;
+  bundle = NULL;
+  displacements = NULL;
+  entries = NULL;
+}
+
+int bundle_active(void) {
+  return bundle != NULL;
+}
+
+// Accept-Encoding에 맞는 표현 (디스크의 사이드카 선택과 같은 우선순위)
+static content_encoding select_representation(const bundle_entry *entry, int accept_encodings) {
+  if ((accept_encodings & ACCEPT_ENCODING_BR) && entry->representations[ENCODING_BR].present) {
+    return ENCODING_BR;
+  }
+  if ((accept_encodings & ACCEPT_ENCODING_GZIP) && entry->representations[ENCODING_GZIP].present) {
+    return ENCODING_GZIP;
+  }
+  return ENCODING_IDENTITY;
+}
+
+// 요청 경로의 엔트리 (없으면 NULL)
+static const bundle_entry *find_entry(const char *request_path) {
+  if (!bundle || bundle->entry_count == 0) return NULL;
+
+  // 키: 정규화된 상대 경로 (소문자), 잘못된 경로는 디스크 경로에서 403 처리
+  char key[PATH_MAX];
+  if (canonicalize_path(request_path, key, sizeof(key)) != PATH_OK) return NULL;
+  if (!key[0]) strcpy(key, "index.html");
+  size_t length = strlen(key);
+  for (size_t i = 0; i < length; i++) {
+    key[i] = (char) tolower((unsigned char) key[i]);
+  }
+
+  unsigned int bucket = bundle_bucket(key, length, bundle->bucket_count);
+  unsigned int slot = bundle_slot(key, length, displacements[bucket], bundle->entry_count);
+  const bundle_entry *entry = &entries[slot];
+
+  // 번들에 없는 키도 어떤 슬롯에 대응하므로 키 비교로 확인
+  if (entry->path_length != length || !in_bundle(entry->path_offset, length) ||
+      memcmp(bundle_view + entry->path_offset, key, length) != 0) {
+    return NULL;
+  }
+  return entry;
+}
+
+int bundle_contains(const char *request_path) {
+  return find_entry(request_path) != NULL;
+}
+
+int bundle_lookup(const char *request_path, int accept_encodings, file_result *result) {
+  const bundle_entry *entry = find_entry(request_path);
+  if (!entry) return 0;
+
+  content_encoding encoding = select_representation(entry, accept_encodings);
+  const bundle_representation *representation = &entry->representations[encoding];
+  const char *content_type = bundle_string(entry->content_type_offset);
+  const char *last_modified = bundle_string(entry->last_modified_offset);
+  if (!representation->present || !content_type || !last_modified ||
+      !in_bundle(representation->data_offset, representation->data_length) ||
+      !in_bundle(representation->header_offset, representation->header_length) ||
+      representation->data_length > (size_t) -1) {
+    return 0;
+  }
+
+  result->data = (char *) (bundle_view + representation->data_offset);
+  result->size = (size_t) representation->data_length;
+  result->content_type = content_type;
+  result->status_code = 200;
+  result->encoding = encoding;
+  result->varies = entry->representations[ENCODING_GZIP].present || entry->representations[ENCODING_BR].present;
+  result->last_modified = last_modified;
+  result->mtime = (time_t) entry->mtime;
+  result->from_bundle = 1;
+  result->header_block = bundle_view + representation->header_offset;
+  result->header_length = representation->header_length;
+  memcpy(result->etag, representation->etag, sizeof(representation->etag));
+  result->etag[sizeof(representation->etag) - 1] = '\0';
+  return 1;
+}
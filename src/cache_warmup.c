@@ -0,0 +1,351 @@
+/*
+ * 시작 시 캐시 예열
+ * - 디렉토리 스캔: 공유 디렉토리 스택을 여러 스레드가 꺼내 처리 (하위 디렉토리는 다시 스택에)
+ * - 적재: 선택된 목록의 인덱스를 원자적으로 나눠 가지며 lookup/load로 일반 요청과 같은 경로 사용
+ */
+
+#include "cache_warmup.h"
+#include "file_handler.h"
+#include "http_parser.h"
+#include "error_handle.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <process.h>
+
+#define WARMUP_MAX_THREADS 32
+#define WARMUP_PATH_MAX 1024
+#define WARMUP_PROGRESS_STEP 50 // 진행 상황 출력 간격 (파일 수)
+
+typedef struct {
+  char path[WARMUP_PATH_MAX]; // 요청 경로 ("/images/a.png")
+  unsigned long long size;
+} warmup_file;
+
+static struct {
+  char root[WARMUP_PATH_MAX];
+  unsigned long long budget;
+  size_t stream_min_size; // 이 크기 이상은 요청 시 스트리밍되므로 예열하지 않음
+  int thread_count;
+  volatile LONG cancel;
+  HANDLE background; // 백그라운드 모드 조정 스레드
+
+  // 디렉토리 스캔 (상대 경로 스택)
+  SRWLOCK lock;
+  CONDITION_VARIABLE changed;
+  char **dirs;
+  size_t dir_count;
+  size_t dir_capacity;
+  int scanning; // 디렉토리를 처리 중인 스레드 수
+
+  // 예열 대상
+  warmup_file *files;
+  size_t file_count;
+  size_t file_capacity;
+
+  // 적재 진행
+  volatile LONG next_index;
+  volatile LONG done_count;
+  volatile LONGLONG loaded_bytes;
+  size_t target_count;
+} warmup;
+
+static int push_dir(const char *relative) {
+  if (warmup.dir_count == warmup.dir_capacity) {
+    size_t capacity = warmup.dir_capacity ? warmup.dir_capacity * 2 : 64;
+    char **grown = (char **) realloc(warmup.dirs, capacity * sizeof(char *));
+    if (!grown) return -1;
+    warmup.dirs = grown;
+    warmup.dir_capacity = capacity;
+  }
+  char *copy = strdup(relative);
+  if (!copy) return -1;
+  warmup.dirs[warmup.dir_count++] = copy;
+  return 0;
+}
+
+static void push_file(const char *request_path, unsigned long long size) {
+  if (warmup.file_count == warmup.file_capacity) {
+    size_t capacity = warmup.file_capacity ? warmup.file_capacity * 2 : 256;
+    warmup_file *grown = (warmup_file *) realloc(warmup.files, capacity * sizeof(warmup_file));
+    if (!grown) return;
+    warmup.files = grown;
+    warmup.file_capacity = capacity;
+  }
+  warmup_file *file = &warmup.files[warmup.file_count++];
+  strncpy(file->path, request_path, sizeof(file->path) - 1);
+  file->path[sizeof(file->path) - 1] = '\0';
+  file->size = size;
+}
+
+// 사이드카는 원본 파일을 예열할 때 함께 적재
+static int is_sidecar(const char *name) {
+  size_t len = strlen(name);
+  return (len > 3 && _stricmp(name + len - 3, ".gz") == 0) ||
+         (len > 3 && _stricmp(name + len - 3, ".br") == 0);
+}
+
+// 요청 경로용 인코딩 (비예약 문자와 '/' 외에는 %XX)
+static int encode_request_path(const char *relative, char *out, size_t out_size) {
+  static const char HEX[] = "0123456789ABCDEF";
+  size_t len = 0;
+  if (out_size < 2) return -1;
+  out[len++] = '/';
+  for (const unsigned char *p = (const unsigned char *) relative; *p; p++) {
+    int plain = (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') ||
+                *p == '-' || *p == '_' || *p == '.' || *p == '~' || *p == '/';
+    if (len + (plain ? 1 : 3) >= out_size) return -1;
+    if (plain) {
+      out[len++] = (char) *p;
+    } else {
+      out[len++] = '%';
+      out[len++] = HEX[*p >> 4];
+      out[len++] = HEX[*p & 0x0F];
+    }
+  }
+  out[len] = '\0';
+  return 0;
+}
+
+// 디렉토리 하나 스캔 (하위 디렉토리는 스택에, 파일은 목록에)
+static void scan_dir(const char *relative) {
+  char pattern[WARMUP_PATH_MAX];
+  snprintf(pattern, sizeof(pattern), "%s%s%s\\*", warmup.root, relative[0] ? "\\" : "", relative);
+
+  WIN32_FIND_DATA data;
+  HANDLE find = FindFirstFile(pattern, &data);
+  if (find == INVALID_HANDLE_VALUE) return;
+
+  do {
+    // '.'으로 시작하는 이름, 숨김/시스템 파일, 링크는 요청으로도 접근할 수 없으므로 제외
+    if (data.cFileName[0] == '.') continue;
+    if (data.dwFileAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM | FILE_ATTRIBUTE_REPARSE_POINT)) {
+      continue;
+    }
+
+    char child[WARMUP_PATH_MAX];
+    int written = snprintf(child, sizeof(child), "%s%s%s", relative, relative[0] ? "/" : "", data.cFileName);
+    if (written < 0 || (size_t) written >= sizeof(child)) continue;
+
+    AcquireSRWLockExclusive(&warmup.lock);
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      push_dir(child);
+      WakeConditionVariable(&warmup.changed);
+    } else if (!is_sidecar(data.cFileName)) {
+      char request_path[WARMUP_PATH_MAX];
+      if (encode_request_path(child, request_path, sizeof(request_path)) == 0) {
+        push_file(request_path, ((unsigned long long) data.nFileSizeHigh << 32) | data.nFileSizeLow);
+      }
+    }
+    ReleaseSRWLockExclusive(&warmup.lock);
+  } while (!warmup.cancel && FindNextFile(find, &data));
+
+  FindClose(find);
+}
+
+static unsigned __stdcall scan_worker(void *arg) {
+  (void) arg;
+
+  AcquireSRWLockExclusive(&warmup.lock);
+  while (!warmup.cancel) {
+    if (warmup.dir_count == 0) {
+      // 다른 스레드가 하위 디렉토리를 더 넣을 수 있으면 대기
+      if (warmup.scanning == 0) break;
+      SleepConditionVariableSRW(&warmup.changed, &warmup.lock, INFINITE, 0);
+      continue;
+    }
+
+    char *relative = warmup.dirs[--warmup.dir_count];
+    warmup.scanning++;
+    ReleaseSRWLockExclusive(&warmup.lock);
+
+    scan_dir(relative);
+    free(relative);
+
+    AcquireSRWLockExclusive(&warmup.lock);
+    warmup.scanning--;
+    if (warmup.scanning == 0 && warmup.dir_count == 0) {
+      WakeAllConditionVariable(&warmup.changed);
+    }
+  }
+  ReleaseSRWLockExclusive(&warmup.lock);
+  return 0;
+}
+
+// 예산에서 size만큼 예약 (예산을 넘으면 0, 여러 스레드가 동시에 예약해도 넘지 않음)
+static int reserve_budget(unsigned long long size) {
+  LONGLONG current = warmup.loaded_bytes;
+  while ((unsigned long long) current + size <= warmup.budget) {
+    LONGLONG seen = InterlockedCompareExchange64(&warmup.loaded_bytes, current + (LONGLONG) size, current);
+    if (seen == current) return 1;
+    current = seen;
+  }
+  return 0;
+}
+
+// 파일 하나 예열: 가능한 모든 표현과 헤더 블록 적재
+static void warm_file(const warmup_file *target) {
+  static const int ACCEPT_SETS[] = {
+    ACCEPT_ENCODING_BR | ACCEPT_ENCODING_GZIP,
+    ACCEPT_ENCODING_GZIP,
+    0
+  };
+
+  for (size_t i = 0; i < sizeof(ACCEPT_SETS) / sizeof(ACCEPT_SETS[0]); i++) {
+    file_result file = lookup_file(warmup.root, target->path, ACCEPT_SETS[i]);
+    if (file.status_code == 200 && !file.data && file.size < warmup.stream_min_size) {
+      // 읽기 전에 예약하고, 읽지 못했거나 캐시에 넣지 못했으면 반납
+      unsigned long long reserved = file.size;
+      if (reserve_budget(reserved) && (!load_file_data(&file) || !file.cache_ref)) {
+        InterlockedExchangeAdd64(&warmup.loaded_bytes, -(LONGLONG) reserved);
+      }
+    }
+    if (file.status_code == 200 && file.cache_ref) {
+      cache_get_header(file.cache_ref, &file);
+    }
+    free_file_result(&file);
+  }
+}
+
+static unsigned __stdcall load_worker(void *arg) {
+  (void) arg;
+
+  while (!warmup.cancel) {
+    LONG index = InterlockedIncrement(&warmup.next_index) - 1;
+    if ((size_t) index >= warmup.target_count) break;
+    if ((unsigned long long) warmup.loaded_bytes >= warmup.budget) break;
+
+    warm_file(&warmup.files[index]);
+
+    LONG done = InterlockedIncrement(&warmup.done_count);
+    if (done % WARMUP_PROGRESS_STEP == 0) {
+      printf("Warm-up: %ld/%zu files, %lld bytes\n", done, warmup.target_count, warmup.loaded_bytes);
+    }
+  }
+  return 0;
+}
+
+// 스레드 n개로 worker 실행 후 모두 끝날 때까지 대기
+static void run_workers(unsigned (__stdcall *worker)(void *)) {
+  HANDLE threads[WARMUP_MAX_THREADS];
+  int started = 0;
+  for (int i = 0; i < warmup.thread_count; i++) {
+    threads[started] = (HANDLE) _beginthreadex(NULL, 0, worker, NULL, 0, NULL);
+    if (threads[started]) started++;
+  }
+  if (started == 0) {
+    worker(NULL); // 스레드를 못 만들면 현재 스레드에서 실행
+    return;
+  }
+  WaitForMultipleObjects((DWORD) started, threads, TRUE, INFINITE);
+  for (int i = 0; i < started; i++) {
+    CloseHandle(threads[i]);
+  }
+}
+
+// hot-list 파일 읽기 (한 줄에 요청 경로 하나, '#'은 주석), 성공 시 1
+static int load_hot_list(const char *path) {
+  if (!path || !path[0]) return 0;
+  FILE *fp = fopen(path, "r");
+  if (!fp) return 0;
+
+  char line[WARMUP_PATH_MAX];
+  while (fgets(line, sizeof(line), fp)) {
+    line[strcspn(line, "\r\n#")] = '\0';
+    char *start = line;
+    while (*start == ' ' || *start == '\t') start++;
+    if (!*start) continue;
+    push_file(start, 0);
+  }
+  fclose(fp);
+  printf("Warm-up: %zu paths from hot list %s\n", warmup.file_count, path);
+  return 1;
+}
+
+static int compare_size(const void *a, const void *b) {
+  unsigned long long size_a = ((const warmup_file *) a)->size;
+  unsigned long long size_b = ((const warmup_file *) b)->size;
+  return (size_a > size_b) - (size_a < size_b);
+}
+
+static void free_warmup_lists(void) {
+  for (size_t i = 0; i < warmup.dir_count; i++) {
+    free(warmup.dirs[i]);
+  }
+  free(warmup.dirs);
+  free(warmup.files);
+  warmup.dirs = NULL;
+  warmup.files = NULL;
+  warmup.dir_count = warmup.dir_capacity = 0;
+  warmup.file_count = warmup.file_capacity = 0;
+}
+
+static unsigned __stdcall run_warmup(void *arg) {
+  const char *hot_list = (const char *) arg;
+  LARGE_INTEGER frequency, start, end;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&start);
+
+  // 예열 목록 (hot-list가 없으면 스캔 후 작은 파일부터: 예산 안에서 가장 많은 요청을 덮음)
+  if (!load_hot_list(hot_list)) {
+    push_dir("");
+    run_workers(scan_worker);
+    qsort(warmup.files, warmup.file_count, sizeof(warmup_file), compare_size);
+    printf("Warm-up: scanned %zu files\n", warmup.file_count);
+  }
+
+  // 캐시 용량을 넘기면 먼저 넣은 것이 밀려나므로 용량까지만
+  size_t capacity = cache_capacity();
+  warmup.target_count = warmup.file_count < capacity ? warmup.file_count : capacity;
+
+  run_workers(load_worker);
+
+  QueryPerformanceCounter(&end);
+  printf("Warm-up %s: %ld files, %lld bytes in %lld ms\n",
+         warmup.cancel ? "cancelled" : "done",
+         warmup.done_count,
+         warmup.loaded_bytes,
+         (end.QuadPart - start.QuadPart) * 1000 / frequency.QuadPart);
+
+  free_warmup_lists();
+  return 0;
+}
+
+int cache_warmup_start(const server_config *config) {
+  if (config->warmup_mode == WARMUP_OFF) return 0;
+
+  memset(&warmup, 0, sizeof(warmup));
+  InitializeSRWLock(&warmup.lock);
+  InitializeConditionVariable(&warmup.changed);
+  strncpy(warmup.root, config->document_root, sizeof(warmup.root) - 1);
+  warmup.budget = config->warmup_budget;
+  warmup.stream_min_size = config->stream_min_size;
+  warmup.thread_count = config->warmup_threads;
+  if (warmup.thread_count < 1) warmup.thread_count = 1;
+  if (warmup.thread_count > WARMUP_MAX_THREADS) warmup.thread_count = WARMUP_MAX_THREADS;
+
+  if (config->warmup_mode == WARMUP_BLOCKING) {
+    run_warmup((void *) config->warmup_hot_list);
+    return 0;
+  }
+
+  warmup.background = (HANDLE) _beginthreadex(NULL, 0, run_warmup, (void *) config->warmup_hot_list, 0, NULL);
+  if (!warmup.background) {
+    LOG_ERROR("Failed to start background warm-up", NULL);
+    return -1;
+  }
+  return 0;
+}
+
+void cache_warmup_stop(void) {
+  if (!warmup.background) return;
+
+  InterlockedExchange(&warmup.cancel, 1);
+  AcquireSRWLockExclusive(&warmup.lock);
+  WakeAllConditionVariable(&warmup.changed);
+  ReleaseSRWLockExclusive(&warmup.lock);
+
+  WaitForSingleObject(warmup.background, INFINITE);
+  CloseHandle(warmup.background);
+  warmup.background = NULL;
+}
@@ -0,0 +1,133 @@
+/*
+ * 응답 본문 압축
+ * 1. gzip: deflate + gzip 헤더 (windowBits 15 + 16)
+ * 2. br: BrotliEncoderCompress 한 번 호출
+ */
+
+#include "compress.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#define GZIP_LEVEL 6 // 정적 파일은 한 번만 압축하므로 기본값보다 높일 여지 있음
+#define BROTLI_LEVEL 9
+
+int is_compressible_type(const char *content_type) {
+  static const char *const COMPRESSIBLE_TYPES[] = {
+    "text/",
+    "application/javascript",
+    "application/json",
+    "application/xml",
+    "image/svg+xml",
+    NULL
+  };
+
+  for (const char *const *type = COMPRESSIBLE_TYPES; *type; type++) {
+    if (strncmp(content_type, *type, strlen(*type)) == 0) return 1;
+  }
+  return 0;
+}
+
+int compress_supported(content_encoding encoding) {
+  switch (encoding) {
+#ifdef HAVE_ZLIB
+    case ENCODING_GZIP: return 1;
+#endif
+#ifdef HAVE_BROTLI
+    case ENCODING_BR: return 1;
+#endif
+    default: return 0;
+  }
+}
+
+#ifdef HAVE_ZLIB
+static int compress_gzip(const char *src, size_t src_len, char **out, size_t *out_len) {
+  z_stream stream = {0};
+  if (deflateInit2(&stream, GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return -1;
+  }
+
+  // 원본보다 커지면 의미 없으므로 원본 크기만큼만 할당
+  uLong bound = deflateBound(&stream, (uLong) src_len);
+  size_t capacity = bound < src_len ? bound : src_len;
+  char *buffer = (char *) malloc(capacity ? capacity : 1);
+  if (!buffer) {
+    deflateEnd(&stream);
+    return -1;
+  }
+
+  stream.next_in = (Bytef *) src;
+  stream.avail_in = (uInt) src_len;
+  stream.next_out = (Bytef *) buffer;
+  stream.avail_out = (uInt) capacity;
+
+  int result = deflate(&stream, Z_FINISH);
+  size_t produced = stream.total_out;
+  deflateEnd(&stream);
+
+  if (result != Z_STREAM_END || produced >= src_len) {
+    free(buffer);
+    return -1;
+  }
+
+  *out = buffer;
+  *out_len = produced;
+  return 0;
+}
+#endif
+
+#ifdef HAVE_BROTLI
+static int compress_brotli(const char *src, size_t src_len, char **out, size_t *out_len) {
+  size_t capacity = src_len;
+  char *buffer = (char *) malloc(capacity ? capacity : 1);
+  if (!buffer) return -1;
+
+  size_t produced = capacity;
+  if (!BrotliEncoderCompress(BROTLI_LEVEL,
+                             BROTLI_DEFAULT_WINDOW,
+                             BROTLI_MODE_TEXT,
+                             src_len,
+                             (const uint8_t *) src,
+                             &produced,
+                             (uint8_t *) buffer) ||
+      produced >= src_len) {
+    free(buffer);
+    return -1;
+  }
+
+  *out = buffer;
+  *out_len = produced;
+  return 0;
+}
+#endif
+
+int compress_buffer(content_encoding encoding,
+                    const char *src,
+                    size_t src_len,
+                    char **out,
+                    size_t *out_len) {
+  // 32비트 길이 한계를 넘는 파일은 압축하지 않음
+  if (src_len == 0 || src_len > 0x7FFFFFFF) return -1;
+
+  switch (encoding) {
+#ifdef HAVE_ZLIB
+    case ENCODING_GZIP:
+      return compress_gzip(src, src_len, out, out_len);
+#endif
+#ifdef HAVE_BROTLI
+    case ENCODING_BR:
+      return compress_brotli(src, src_len, out, out_len);
+#endif
+    default:
+      (void) src;
+      (void) out;
+      (void) out_len;
+      return -1;
+  }
+}
@@ -16,7 +16,26 @@ server_config load_default_config(void) {
     .port = 8080,
     .buffer_size = 1024,
     .max_connections = 1000,
-    .backlog_size = 5
+    .backlog_size = 5,
+    .open_file_cache_max = 1000,
+    .open_file_cache_valid = 60,
+    .negative_cache_ttl = 10,
+    .compress_dynamic = 1,
+    .compress_min_size = 1024,
+    .inline_max_size = 4 * 1024,
+    .stream_min_size = 1024 * 1024,
+    .transmit_file = 1,
+    .slice_cache_size = 128 * 1024 * 1024,
+    .cache_mmap = 0,
+    .cache_mmap_min_size = 64 * 1024,
+    .upload_sync = 0,
+    .upload_dedup = 0,
+    .warmup_mode = 0,
+    .warmup_threads = 4,
+    .warmup_budget = 64 * 1024 * 1024,
+    .error_log_file = "server_error.log",
+    .error_log_max_size = 10 * 1024 * 1024,
+    .error_log_rotate_interval = 24 * 60 * 60
   };
 
   char exe_path[1024] = {0};
@@ -36,6 +55,24 @@ server_config load_default_config(void) {
            "%s\\static",
            exe_path);
 
+  // 예열 hot-list (static 폴더와 같은 위치, 없으면 스캔)
+  snprintf(config.warmup_hot_list,
+           sizeof(config.warmup_hot_list),
+           "%s\\warmup.list",
+           exe_path);
+
+  // MIME 매핑 파일 (static 폴더와 같은 위치)
+  snprintf(config.mime_types_file,
+           sizeof(config.mime_types_file),
+           "%s\\mime.types",
+           exe_path);
+
+  // 정적 파일 번들 (없으면 document_root에서 제공)
+  snprintf(config.bundle_file,
+           sizeof(config.bundle_file),
+           "%s\\static.bundle",
+           exe_path);
+
   strncpy(config.server_name, "C Web Server", sizeof(config.server_name) - 1);
 
   return config;
@@ -56,6 +93,19 @@ int validate_config(const server_config *config) {
   // 대기열 크기 체크
   if (config->backlog_size <= 0) return 0;
 
+  // 열린 파일 캐시 체크
+  if (config->open_file_cache_max == 0 || config->open_file_cache_valid < 0) return 0;
+  if (config->negative_cache_ttl < 0) return 0;
+
+  // 크기 계층 체크 (인라인 구간은 스트리밍 구간보다 작아야 함)
+  if (config->inline_max_size >= config->stream_min_size) return 0;
+
+  // 에러 로그 체크
+  if (!config->error_log_file[0] || config->error_log_rotate_interval < 0) return 0;
+
+  // 예열 체크
+  if (config->warmup_mode < 0 || config->warmup_mode > 2 || config->warmup_threads <= 0) return 0;
+
   return 1;
 }
 
@@ -67,5 +117,33 @@ void print_config(const server_config *config) {
   printf("Max Connections: %d\n", config->max_connections);
   printf("Backlog Size: %d\n", config->backlog_size);
   printf("Server Name: %s\n", config->server_name);
+  printf("Open File Cache: %zu entries, %d s valid\n",
+         config->open_file_cache_max,
+         config->open_file_cache_valid);
+  printf("Negative Cache TTL: %d s\n", config->negative_cache_ttl);
+  printf("Dynamic Compression: %s (min %zu bytes)\n",
+         config->compress_dynamic ? "on" : "off",
+         config->compress_min_size);
+  printf("Size Tiers: inline <= %zu bytes, stream >= %zu bytes (%s)\n",
+         config->inline_max_size,
+         config->stream_min_size,
+         config->transmit_file ? "TransmitFile" : "read-ahead");
+  printf("Slice Cache: %zu bytes\n", config->slice_cache_size);
+  printf("Cache mmap: %s (%zu bytes up to stream size)\n",
+         config->cache_mmap ? "on" : "off",
+         config->cache_mmap_min_size);
+  printf("Upload Sync: %s, Dedup: %s\n",
+         config->upload_sync ? "on" : "off",
+         config->upload_dedup ? "on" : "off");
+  printf("Warm-up: mode %d, %d threads, budget %zu bytes\n",
+         config->warmup_mode,
+         config->warmup_threads,
+         config->warmup_budget);
+  printf("MIME Types File: %s\n", config->mime_types_file);
+  printf("Bundle File: %s\n", config->bundle_file);
+  printf("Error Log: %s (rotate at %zu bytes or %d s)\n",
+         config->error_log_file,
+         config->error_log_max_size,
+         config->error_log_rotate_interval);
   printf("==========================\n\n");
 }
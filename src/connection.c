@@ -4,7 +4,13 @@
 
 #include "http_parser.h"
 #include "file_handler.h"
+#include "open_file_cache.h"
+#include "date_cache.h"
+#include "upload_file.h"
+#include "blob_store.h"
+#include "bundle.h"
 #include "server.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -55,6 +61,7 @@ static void send_json_response(SOCKET client_socket,
   snprintf(response,
            sizeof(response),
            "HTTP/1.1 %d %s\r\n"
+           "Date: %s\r\n"
            "Content-Type: application/json\r\n"
            "Connection: close\r\n"
            "\r\n"
@@ -64,6 +71,7 @@ static void send_json_response(SOCKET client_socket,
            "}",
            status_code,
            message,
+           http_date_now(),
            status_code,
            message,
            detail ? ",\"detail\":\"" : "",
@@ -74,8 +82,8 @@ static void send_json_response(SOCKET client_socket,
 
 // POST 요청 처리
 static void handle_post_request(SOCKET client_socket, http_request *req) {
-  printf("\n=== Processing POST Request ===\n");
-  printf("Content-Type: %s\n", get_header_value(req, "Content-Type"));
+  LOG_DEBUG("=== Processing POST Request ===");
+  LOG_DEBUG("Content-Type: %s", get_header_value(req, "Content-Type"));
 
   char detail[1024] = {0};
 
@@ -87,11 +95,11 @@ static void handle_post_request(SOCKET client_socket, http_request *req) {
                "Received %d form parameters",
                req->post_param_count);
 
-      printf("Form parameters:\n");
+      LOG_DEBUG("Form parameters:");
       for (int i = 0; i < req->post_param_count; i++) {
-        printf("  %s: %s\n",
-               req->post_params[i].name,
-               req->post_params[i].value);
+        LOG_DEBUG("  %s: %s",
+                  req->post_params[i].name,
+                  req->post_params[i].value);
       }
       break;
     }
@@ -103,22 +111,22 @@ static void handle_post_request(SOCKET client_socket, http_request *req) {
                "Processed %d JSON fields",
                req->json_field_count);
 
-      printf("JSON fields:\n");
+      LOG_DEBUG("JSON fields:");
       for (int i = 0; i < req->json_field_count; i++) {
-        printf("  %s: ", req->json_fields[i].key);
+        const char *key = req->json_fields[i].key;
         switch (req->json_fields[i].value.type) {
           case JSON_STRING:
-            printf("%s (string)\n", req->json_fields[i].value.string_value);
+            LOG_DEBUG("  %s: %s (string)", key, req->json_fields[i].value.string_value);
             break;
           case JSON_NUMBER:
-            printf("%f (number)\n", req->json_fields[i].value.number_value);
+            LOG_DEBUG("  %s: %f (number)", key, req->json_fields[i].value.number_value);
             break;
           case JSON_BOOLEAN:
-            printf("%s (boolean)\n",
-                   req->json_fields[i].value.boolean_value ? "true" : "false");
+            LOG_DEBUG("  %s: %s (boolean)", key,
+                      req->json_fields[i].value.boolean_value ? "true" : "false");
             break;
           case JSON_NULL:
-            printf("null\n");
+            LOG_DEBUG("  %s: null", key);
             break;
         }
       }
@@ -152,43 +160,74 @@ static void handle_post_request(SOCKET client_socket, http_request *req) {
                "Received %d files",
                req->file_count);
 
-      printf("Files:\n");
+      LOG_DEBUG("Files:");
       int success_count = 0;
 
       for (int i = 0; i < req->file_count; i++) {
-        printf("  Filename: %s\n", req->files[i].filename);
-        printf("  Content-Type: %s\n", req->files[i].content_type);
-        printf("  Size: %zu bytes\n", req->files[i].size);
+        LOG_DEBUG("  Filename: %s", req->files[i].filename);
+        LOG_DEBUG("  Content-Type: %s", req->files[i].content_type);
+        LOG_DEBUG("  Size: %zu bytes", req->files[i].size);
 
         // 파일 이름 검증
         if (!is_path_safe(req->files[i].filename)) {
-          printf("  Invalid filename!\n");
+          LOG_DEBUG("  Invalid filename!");
           continue;
         }
 
         // 파일 저장 처리
-        char filepath[2048];
-        snprintf(filepath,
-                 sizeof(filepath),
-                 "%s%c%s",
-                 uploads_dir,
-                 PATH_SEPARATOR,
-                 req->files[i].filename);
-
-        FILE *fp = fopen(filepath, "wb");
-        if (fp) {
-          size_t written = fwrite(req->files[i].data, 1, req->files[i].size, fp);
-          fclose(fp);
-
-          if (written == req->files[i].size) {
-            printf("  Saved to: %s\n", filepath);
+        char upload_path[1024];
+        char filepath[PATH_MAX];
+        snprintf(upload_path, sizeof(upload_path), "/uploads/%s", req->files[i].filename);
+        if (resolve_request_path(g_server->config.document_root,
+                                 upload_path,
+                                 filepath,
+                                 sizeof(filepath)) != 200) {
+          LOG_DEBUG("  Invalid filename!");
+          continue;
+        }
+
+        // 번들에 있는 경로는 저장해도 제공되지 않으므로 건너뜀
+        if (bundle_contains(upload_path)) {
+          LOG_WARN("  Upload path is served from the bundle: %s", upload_path);
+          continue;
+        }
+
+        // 이전 업로드의 핸들과 매핑된 캐시 엔트리, 요청 경로의 부정 캐시 제거
+        open_file_cache_invalidate_request(upload_path);
+        cache_invalidate(filepath);
+
+        // 중복 제거 모드는 내용 해시 blob에 대한 링크로 저장 (같은 내용이면 쓰기 생략)
+        if (blob_store_enabled()) {
+          int deduplicated = 0;
+          if (blob_store_put(filepath, req->files[i].data, req->files[i].size,
+                             g_server->config.upload_sync, &deduplicated) == 0) {
+            LOG_INFO("  Saved to: %s%s", filepath, deduplicated ? " (deduplicated)" : "");
             success_count++;
           } else {
-            printf("  Failed to write file completely!\n");
-            remove(filepath); // 실패한 파일 삭제
+            LOG_WARN("  Failed to store file!");
           }
+          cache_invalidate(filepath);
+          continue;
+        }
+
+        // 임시 파일에 쓰고 이름만 교체 (이전 중복 제거로 blob에 링크된 이름도 내용은 덮어쓰지 않음)
+        upload_file *upload = upload_begin(filepath, req->files[i].size);
+        if (!upload) {
+          LOG_WARN("  Failed to create file!");
+          continue;
+        }
+        if (upload_write(upload, req->files[i].data, req->files[i].size) != 0) {
+          upload_abort(upload);
+          LOG_WARN("  Failed to write file completely!");
+          continue;
+        }
+        int committed = upload_commit(upload, g_server->config.upload_sync) == 0;
+        cache_invalidate(filepath);
+        if (committed) {
+          LOG_INFO("  Saved to: %s", filepath);
+          success_count++;
         } else {
-          printf("  Failed to create file!\n");
+          LOG_WARN("  Failed to replace file!");
         }
       }
 
@@ -214,9 +253,13 @@ static void handle_post_request(SOCKET client_socket, http_request *req) {
 }
 
 // PUT 요청 처리
-static void handle_put_request(SOCKET client_socket, http_request *req) {
-  printf("\n=== Processing PUT Request ===\n");
-  printf("Path: %s\n", req->base_path);
+static void handle_put_request(client_connection *conn,
+                               http_request *req,
+                               const char *body,
+                               size_t body_received) {
+  SOCKET client_socket = conn->socket;
+  LOG_DEBUG("=== Processing PUT Request ===");
+  LOG_DEBUG("Path: %s", req->base_path);
 
   // 서버 인스턴스 체크
   if (!g_server) {
@@ -224,47 +267,88 @@ static void handle_put_request(SOCKET client_socket, http_request *req) {
     return;
   }
 
+  // 본문은 Content-Length만큼 받아 바로 파일에 기록 (chunked 전송은 지원하지 않음)
+  // 헤더가 없으면 길이 0으로 파싱되므로 빈 파일로 덮어쓰지 않도록 헤더 존재를 직접 확인
+  if (!get_header_value(req, "Content-Length") || req->content_length < 0 ||
+      get_header_value(req, "Transfer-Encoding")) {
+    send_json_response(client_socket, 411, "Length Required", "Content-Length is required");
+    return;
+  }
+  unsigned long long content_length = (unsigned long long) req->content_length;
+
+  // 번들 경로는 디스크보다 먼저 조회되므로 덮어써도 새 내용이 제공되지 않음
+  if (bundle_contains(req->base_path)) {
+    send_json_response(client_socket, 409, "Conflict", "Path is served from the read-only bundle");
+    return;
+  }
+
   // 상대 경로 정규화 (시작 슬래시 제거)
   const char *relative_path = req->base_path;
   while (*relative_path == '/') relative_path++;
 
-  // 경로 검증
-  if (!is_path_safe(relative_path)) {
+  // 경로 검증 및 전체 경로 생성 (루트 경로는 index.html로 바뀌므로 거부)
+  char full_path[PATH_MAX];
+  if (!*relative_path || resolve_request_path(g_server->config.document_root,
+                           relative_path,
+                           full_path,
+                           sizeof(full_path)) != 200) {
     send_json_response(client_socket, 400, "Bad Request", "Invalid path");
     return;
   }
 
-  // 전체 경로 생성
-  char full_path[1024];
-  snprintf(full_path,
-           sizeof(full_path),
-           "%s%c%s",
-           g_server->config.document_root,
-           PATH_SEPARATOR,
-           relative_path);
-
-  // 파일 저장
-  FILE *fp = fopen(full_path, "wb");
-  if (!fp) {
+  // 같은 디렉토리의 임시 파일에 받음 (기존 파일은 교체 전까지 그대로 제공)
+  upload_file *upload = upload_begin(full_path, content_length);
+  if (!upload) {
     send_json_response(client_socket, 500, "Internal Server Error", "Failed to create file");
     return;
   }
 
-  // raw body를 파일에 쓰기
-  size_t written = fwrite(req->raw_body, 1, req->raw_body_length, fp);
-  fclose(fp);
-
-  if (written != req->raw_body_length) {
-    remove(full_path); // 실패시 파일 삭제
+  // 헤더와 함께 받은 부분, 이어서 소켓에서 받는 부분을 블록 단위로 기록
+  if (body_received > content_length) body_received = (size_t) content_length;
+  int failed = upload_write(upload, body, body_received) != 0;
+  char *block = failed ? NULL : (char *) malloc(CHUNK_SIZE);
+  if (!block) failed = 1;
+  while (!failed && upload_size(upload) < content_length) {
+    unsigned long long remaining = content_length - upload_size(upload);
+    int received = recv(client_socket, block, (int) min(remaining, (unsigned long long) CHUNK_SIZE), 0);
+    if (received <= 0) {
+      // 클라이언트가 끊었으면 임시 파일만 삭제 (대상 파일은 그대로)
+      LOG_WARN("Upload aborted after %llu of %llu bytes", upload_size(upload), content_length);
+      free(block);
+      upload_abort(upload);
+      return;
+    }
+    failed = upload_write(upload, block, (size_t) received) != 0;
+  }
+  free(block);
+  if (failed) {
+    upload_abort(upload);
     send_json_response(client_socket, 500, "Internal Server Error", "Failed to write file");
     return;
   }
 
+  // 캐시된 핸들과 매핑 뷰가 교체를 막지 않도록 먼저 닫고, 이 경로의 부정 캐시도 제거
+  open_file_cache_invalidate_request(req->base_path);
+  cache_invalidate(full_path);
+
+  if (upload_commit(upload, g_server->config.upload_sync) != 0) {
+    cache_invalidate(full_path);
+    send_json_response(client_socket, 500, "Internal Server Error", "Failed to replace file");
+    return;
+  }
+
+  // 교체 중 들어온 이전 내용 무효화 후 새 내용을 캐시에 올려 다음 GET이 바로 히트
+  cache_invalidate(full_path);
+  if (content_length < g_server->config.stream_min_size) {
+    file_result fresh = read_file(g_server->config.document_root, req->base_path, 0);
+    free_file_result(&fresh);
+  }
+
   char detail[256];
   snprintf(detail,
            sizeof(detail),
-           "Successfully wrote %zu bytes to %s",
-           written,
+           "Successfully wrote %llu bytes to %s",
+           content_length,
            relative_path);
 
   send_json_response(client_socket, 201, "Created", detail);
@@ -272,64 +356,68 @@ static void handle_put_request(SOCKET client_socket, http_request *req) {
 
 // 파일 삭제 헬퍼
 static delete_result delete_file(const char *base_path, const char *request_path) {
-  printf("\n=== Processing File Delete ===\n");
-  printf("Base path: %s\n", base_path);
-  printf("Request path: %s\n", request_path);
+  LOG_DEBUG("=== Processing File Delete ===");
+  LOG_DEBUG("Base path: %s", base_path);
+  LOG_DEBUG("Request path: %s", request_path);
+
+  // 번들 경로는 디스크보다 먼저 조회되므로 삭제해도 응답이 바뀌지 않음
+  if (bundle_contains(request_path)) {
+    LOG_DEBUG("Path is served from the bundle");
+    return DELETE_BUNDLED;
+  }
 
   // 상대 경로에서 시작 슬래시 제거
   while (*request_path == '/') request_path++;
 
   // 상대 경로 검증
-  printf("\n=== Path Safety Check ===\n");
-  printf("Checking relative path: %s\n", request_path);
-  if (!is_path_safe(request_path)) {
-    printf("Path security check failed\n");
+  LOG_DEBUG("=== Path Safety Check ===");
+  LOG_DEBUG("Checking relative path: %s", request_path);
+  char full_path[PATH_MAX];
+  if (!*request_path || resolve_request_path(base_path, request_path, full_path, sizeof(full_path)) != 200) {
+    LOG_DEBUG("Path security check failed");
     return DELETE_PATH_INVALID;
   }
-
-  // 전체 경로 생성
-  char full_path[1024];
-  snprintf(full_path,
-           sizeof(full_path),
-           "%s%c%s",
-           base_path,
-           PATH_SEPARATOR,
-           request_path);
-  printf("Full path: %s\n", full_path);
+  LOG_DEBUG("Full path: %s", full_path);
 
   // 파일 존재 여부 확인
   struct stat file_stat;
   if (stat(full_path, &file_stat) != 0) {
-    printf("File not found\n");
+    LOG_DEBUG("File not found");
     return DELETE_FILE_NOT_FOUND;
   }
 
   // 디렉토리 삭제 방지
   if (S_ISDIR(file_stat.st_mode)) {
-    printf("Cannot delete directory\n");
+    LOG_DEBUG("Cannot delete directory");
     return DELETE_ACCESS_DENIED;
   }
 
   // 파일 접근 권한 확인
   if (access(full_path, W_OK) != 0) {
-    printf("Access denied\n");
+    LOG_DEBUG("Access denied");
     return DELETE_ACCESS_DENIED;
   }
 
+  // 캐시된 핸들이나 매핑 뷰가 남아 있으면 삭제 대기 상태로 이름이 남으므로 먼저 닫기
+  cache_invalidate(full_path);
+
   // 파일 삭제 시도
   if (remove(full_path) != 0) {
-    printf("Delete failed: %s\n", strerror(errno));
+    LOG_WARN("Delete failed: %s", strerror(errno));
     return DELETE_ERROR;
   }
 
-  printf("File successfully deleted\n");
+  // 캐시에서도 제거
+  cache_invalidate(full_path);
+
+  LOG_INFO("File successfully deleted");
   return DELETE_SUCCESS;
 }
 
 // DELETE 요청 처리
 static void handle_delete_request(SOCKET client_socket, http_request *req) {
-  printf("\n=== Processing DELETE Request ===\n");
-  printf("Target path: %s\n", req->base_path);
+  LOG_DEBUG("=== Processing DELETE Request ===");
+  LOG_DEBUG("Target path: %s", req->base_path);
 
   // 서버 인스턴스 체크
   if (!g_server) {
@@ -350,16 +438,6 @@ static void handle_delete_request(SOCKET client_socket, http_request *req) {
                "Successfully deleted file: %s",
                req->base_path);
       send_json_response(client_socket, 200, "OK", detail);
-
-      // 캐시에서도 제거
-      char full_path[1024];
-      snprintf(full_path,
-               sizeof(full_path),
-               "%s%c%s",
-               g_server->config.document_root,
-               PATH_SEPARATOR,
-               req->base_path[0] == '/' ? req->base_path + 1 : req->base_path);
-      cache_remove(full_path);
       break;
     }
 
@@ -375,6 +453,10 @@ static void handle_delete_request(SOCKET client_socket, http_request *req) {
       send_json_response(client_socket, 400, "Bad Request", "Invalid path");
       break;
 
+    case DELETE_BUNDLED:
+      send_json_response(client_socket, 409, "Conflict", "Path is served from the read-only bundle");
+      break;
+
     case DELETE_ERROR:
     default:
       send_json_response(client_socket, 500, "Internal Server Error", strerror(errno));
@@ -382,48 +464,10 @@ static void handle_delete_request(SOCKET client_socket, http_request *req) {
   }
 }
 
-// HEAD 요청 처리
-static void handle_head_request(SOCKET client_socket, http_request *req) {
-  // GET과 동일한 헤더를 반환하지만 본문은 제외
-  if (!g_server) {
-    const char *response = "HTTP/1.1 500 Internal Server Error\r\n"
-        "Connection: close\r\n"
-        "\r\n";
-    send(client_socket, response, strlen(response), 0);
-    return;
-  }
-
-  file_result file = read_file(g_server->config.document_root, req->base_path);
-  if (file.status_code != 200) {
-    const char *response = "HTTP/1.1 404 Not Found\r\n"
-        "Connection: close\r\n"
-        "\r\n";
-    send(client_socket, response, strlen(response), 0);
-    free_file_result(&file);
-    return;
-  }
-
-  char header[1024];
-  snprintf(header,
-           sizeof(header),
-           "HTTP/1.1 200 OK\r\n"
-           "Content-Type: %s\r\n"
-           "Content-Length: %zu\r\n"
-           "Connection: close\r\n"
-           "\r\n",
-           file.content_type,
-           file.size);
-
-  send(client_socket, header, strlen(header), 0);
-  free_file_result(&file);
-}
-
 // handle_connection
 void handle_connection(client_connection *conn) {
-  printf("\n=== New Connection Started ===\n");
-  printf("Buffer size: %zu\n", conn->buffer_size);
-  printf("Client IP: %s\n", inet_ntoa(conn->addr.sin_addr));
-  printf("Client Port: %d\n", ntohs(conn->addr.sin_port));
+  LOG_DEBUG("New connection from %s:%d (buffer %zu)",
+            inet_ntoa(conn->addr.sin_addr), ntohs(conn->addr.sin_port), conn->buffer_size);
 
   // 요청 수신 전에 버퍼 초기화
   memset(conn->buffer, 0, conn->buffer_size);
@@ -433,7 +477,6 @@ void handle_connection(client_connection *conn) {
   const char *header_end;
   int found_header_end = 0;
 
-  printf("\n=== Receiving Request ===\n");
   // 헤더를 완전히 받을 때까지 반복
   while (total_received < conn->buffer_size - 1) {
     int received = recv(conn->socket,
@@ -442,7 +485,7 @@ void handle_connection(client_connection *conn) {
                         0);
 
     if (received <= 0) {
-      printf("Connection closed or error occurred\n");
+      LOG_DEBUG("Connection closed or error occurred");
       return;
     }
 
@@ -453,46 +496,37 @@ void handle_connection(client_connection *conn) {
     header_end = strstr(conn->buffer, "\r\n\r\n");
     if (header_end) {
       found_header_end = 1;
-      printf("Found end of headers at position: %td\n", header_end - conn->buffer);
+      LOG_DEBUG("Found end of headers at position: %td", header_end - conn->buffer);
       break;
     }
   }
 
   if (!found_header_end) {
-    printf("Could not find end of headers\n");
+    LOG_WARN("Could not find end of headers");
     return;
   }
 
-  // Raw 요청 출력
-  printf("\n=== Raw Request ===\n%s\n", conn->buffer);
-
-  // 헤더 부분만 출력
   size_t header_length = header_end - conn->buffer + 4;
-  char *headers = (char *) malloc(header_length + 1);
-  if (headers) {
-    memcpy(headers, conn->buffer, header_length);
-    headers[header_length] = '\0';
-    printf("\n=== Parsed Headers ===\n%s\n", headers);
-    free(headers);
-  }
 
-  // HTTP 요청 파싱
+  // HTTP 요청 파싱 (헤더 목록은 디버그 빌드에서만 출력)
   http_request req = parse_http_request(conn->buffer);
+  LOG_INFO("%s %s from %s:%d", get_method_string(req.method), req.path,
+           inet_ntoa(conn->addr.sin_addr), ntohs(conn->addr.sin_port));
   print_http_request(&req);
 
   // 요청 메소드에 따른 처리
   switch (req.method) {
     case HTTP_GET:
-      handle_static_file(conn->socket, &req, req.base_path);
-      break;
     case HTTP_HEAD:
-      handle_head_request(conn->socket, &req);
+      // HEAD는 GET과 같은 응답 빌더에서 본문만 생략
+      handle_static_file(conn->socket, &req, req.base_path);
       break;
     case HTTP_POST:
       handle_post_request(conn->socket, &req);
       break;
     case HTTP_PUT:
-      handle_put_request(conn->socket, &req);
+      // 본문은 요청 버퍼에 담지 않고 헤더 뒤에 이미 받은 부분부터 스트리밍
+      handle_put_request(conn, &req, conn->buffer + header_length, total_received - header_length);
       break;
     case HTTP_DELETE:
       handle_delete_request(conn->socket, &req);
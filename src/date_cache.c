@@ -0,0 +1,54 @@
+/*
+ * 초 단위 시각 문자열 캐시
+ * - 요일/월 이름은 로케일과 무관하게 직접 채움
+ * - 스레드 로컬이라 락 없이 사용
+ */
+
+#include "date_cache.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct {
+  time_t second; // 포맷한 시각
+  char http_date[HTTP_DATE_LEN + 1];
+  char log_time[LOG_TIME_LEN + 1];
+} date_slot;
+
+static THREAD_LOCAL date_slot slot = {(time_t) -1, {0}, {0}};
+
+static const char *const DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char *const MONTH_NAMES[] = {
+  "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+void date_cache_tick(void) {
+  time_t now = time(NULL);
+  if (now == slot.second) return;
+
+  struct tm gmt, local;
+  gmtime_s(&gmt, &now);
+  localtime_s(&local, &now);
+
+  // 숫자 필드만 strftime으로, 요일/월 이름은 로케일과 무관하게 덮어씀
+  strftime(slot.http_date, sizeof(slot.http_date), "Day, %d Mon %Y %H:%M:%S GMT", &gmt);
+  memcpy(slot.http_date, DAY_NAMES[gmt.tm_wday], 3);
+  memcpy(slot.http_date + 8, MONTH_NAMES[gmt.tm_mon], 3);
+  strftime(slot.log_time, sizeof(slot.log_time), "%Y-%m-%d %H:%M:%S", &local);
+  slot.second = now;
+}
+
+const char *http_date_now(void) {
+  date_cache_tick();
+  return slot.http_date;
+}
+
+const char *log_time_now(void) {
+  date_cache_tick();
+  return slot.log_time;
+}
@@ -1,8 +1,32 @@
 #include "error_handle.h"
+#include "date_cache.h"
+#include "hash.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
+#define ERROR_LOG_DEFAULT_PATH "server_error.log"
+#define ERROR_LOG_DEFAULT_MAX_SIZE (10 * 1024 * 1024)
+#define ERROR_LOG_BUFFER_SIZE (64 * 1024) // 파일 스트림 버퍼
+#define ERROR_LOG_KEEP 5 // 보관할 교체 파일 수 (path.1 ~ path.5)
+#define ERROR_LOG_SLOTS 64 // 반복 억제 슬롯 수 (2의 거듭제곱)
+#define ERROR_LOG_RATE_WINDOW 10 // 반복 억제 창 (초)
+#define ERROR_LOG_BURST 5 // 창마다 그대로 기록할 같은 에러 수
+#define ERROR_LOG_REOPEN_EVENT "Local\\webserver_error_log_reopen_%lu" // 프로세스 ID로 구분
+
+// 같은 에러 반복 집계 (위치 + 코드 + 메시지 해시로 슬롯 선택, 충돌하면 밀어냄)
+typedef struct {
+  unsigned long long key;
+  int code;
+  const char *file; // __FILE__ 리터럴
+  int line;
+  char message[128];
+  time_t window_start; // 현재 창 시작
+  int count; // 현재 창에서 발생한 수
+  long suppressed; // 현재 창에서 기록하지 않은 수
+} error_log_slot;
+
 // HTTP 상태 코드에 따른 기본 메시지
 static const char *get_status_text(error_code code) {
   switch (code) {
@@ -62,7 +86,8 @@ static void generate_error_page(char *buffer, size_t size, const error_context *
   );
 }
 
-void send_error_response(SOCKET client_socket, const error_context *err) {
+// 에러 응답 전송 (HEAD 요청이면 본문 제외)
+static void send_error(SOCKET client_socket, const error_context *err, int include_body) {
   char page_buffer[4096];
   generate_error_page(page_buffer, sizeof(page_buffer), err);
 
@@ -70,44 +95,271 @@ void send_error_response(SOCKET client_socket, const error_context *err) {
   snprintf(header,
            sizeof(header),
            "HTTP/1.1 %d %s\r\n"
+           "Date: %s\r\n"
            "Content-Type: text/html\r\n"
            "Content-Length: %zu\r\n"
            "Connection: close\r\n"
            "\r\n",
            err->code,
            get_status_text(err->code),
+           http_date_now(),
            strlen(page_buffer)
   );
 
   // 헤더와 에러 페이지 전송
   send(client_socket, header, strlen(header), 0);
-  send(client_socket, page_buffer, strlen(page_buffer), 0);
+  if (include_body) {
+    send(client_socket, page_buffer, strlen(page_buffer), 0);
+  }
 }
 
-void log_error(const error_context *err) {
-  time_t now;
-  time(&now);
-  char timestamp[64];
-  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
-
-  FILE *log_file = fopen("server_error.log", "a");
-  if (log_file) {
-    fprintf(log_file,
-            "[%s] Error %d: %s\n",
-            timestamp,
-            err->code,
-            err->message);
-    if (err->detail) {
-      fprintf(log_file, "Detail: %s\n", err->detail);
+void send_error_response(SOCKET client_socket, const error_context *err) {
+  send_error(client_socket, err, 1);
+}
+
+void send_error_headers(SOCKET client_socket, const error_context *err) {
+  send_error(client_socket, err, 0);
+}
+
+// 에러 로그 파일 상태 (모든 필드는 lock 보유 중에만 접근, reopen_requested 제외)
+static struct {
+  SRWLOCK lock;
+  FILE *file;
+  int closed; // error_log_close 이후 (stderr만 사용)
+  char path[1024];
+  size_t max_size; // 교체 기준 크기 (0이면 끔)
+  int rotate_interval; // 교체 주기 (초, 0이면 끔)
+  size_t size; // 현재 파일 크기
+  time_t opened_at; // 현재 파일을 연 시각 (시간 교체 기준)
+  time_t flushed_at; // 마지막 플러시 시각
+  int dirty; // 플러시하지 않은 기록이 있음
+  error_log_slot slots[ERROR_LOG_SLOTS];
+} error_log = {.lock = SRWLOCK_INIT};
+
+static volatile LONG reopen_requested;
+
+// 외부 로그 교체 도구용 재열기 트리거 (이름 있는 이벤트, 스레드 풀 대기로 감시)
+static HANDLE reopen_event;
+static HANDLE reopen_wait;
+
+static unsigned long long error_key(const error_context *err) {
+  unsigned long long key = hash64(err->file, strlen(err->file), (unsigned long long) err->line);
+  key = hash64(err->message, strlen(err->message), key);
+  return key ^ (unsigned long long) err->code;
+}
+
+static void error_log_write(const char *text, int length) {
+  if (!error_log.file || length <= 0) return;
+  fwrite(text, 1, (size_t) length, error_log.file);
+  error_log.size += (size_t) length;
+  error_log.dirty = 1;
+}
+
+static void error_log_flush(time_t now) {
+  if (error_log.file && error_log.dirty) fflush(error_log.file);
+  error_log.dirty = 0;
+  error_log.flushed_at = now;
+}
+
+static int error_log_open_file(time_t now) {
+  error_log.file = fopen(error_log.path, "a");
+  if (!error_log.file) return -1;
+
+  // 크게 잡은 버퍼로 한 번에 기록 (플러시는 틱, 교체, 닫기에서)
+  setvbuf(error_log.file, NULL, _IOFBF, ERROR_LOG_BUFFER_SIZE);
+  fseek(error_log.file, 0, SEEK_END);
+  long position = ftell(error_log.file);
+  error_log.size = position > 0 ? (size_t) position : 0;
+  error_log.opened_at = now;
+  error_log.flushed_at = now;
+  return 0;
+}
+
+static void error_log_close_file(time_t now) {
+  if (!error_log.file) return;
+  error_log_flush(now);
+  fclose(error_log.file);
+  error_log.file = NULL;
+}
+
+// path.N-1 -> path.N, ..., path -> path.1 로 밀어내고 새 파일 열기
+static void error_log_rotate(time_t now) {
+  char from[sizeof(error_log.path) + 8];
+  char to[sizeof(error_log.path) + 8];
+
+  error_log_close_file(now);
+  for (int i = ERROR_LOG_KEEP - 1; i >= 0; i--) {
+    if (i == 0) {
+      snprintf(from, sizeof(from), "%s", error_log.path);
+    } else {
+      snprintf(from, sizeof(from), "%s.%d", error_log.path, i);
     }
-    fprintf(log_file, "Location: %s:%d\n\n", err->file, err->line);
-    fclose(log_file);
+    snprintf(to, sizeof(to), "%s.%d", error_log.path, i + 1);
+    MoveFileEx(from, to, MOVEFILE_REPLACE_EXISTING);
   }
+  error_log_open_file(now);
+}
 
-  // 콘솔에도 출력
-  fprintf(stderr, "[%s] Error %d: %s\n", timestamp, err->code, err->message);
-  if (err->detail) {
-    fprintf(stderr, "Detail: %s\n", err->detail);
+// 재열기 요청, 크기/시간 교체 확인 (lock 보유 중)
+static void error_log_maintain(time_t now) {
+  if (error_log.closed) return;
+
+  if (InterlockedExchange(&reopen_requested, 0)) {
+    error_log_close_file(now);
   }
-  fprintf(stderr, "Location: %s:%d\n\n", err->file, err->line);
+  if (!error_log.file) {
+    if (!error_log.path[0]) {
+      snprintf(error_log.path, sizeof(error_log.path), "%s", ERROR_LOG_DEFAULT_PATH);
+      error_log.max_size = ERROR_LOG_DEFAULT_MAX_SIZE;
+    }
+    error_log_open_file(now);
+    return;
+  }
+
+  if ((error_log.max_size > 0 && error_log.size >= error_log.max_size) ||
+      (error_log.rotate_interval > 0 && now - error_log.opened_at >= error_log.rotate_interval)) {
+    error_log_rotate(now);
+  }
+}
+
+// 억제된 반복 요약 기록 후 슬롯 창 초기화 (lock 보유 중)
+static void error_log_summarize(error_log_slot *slot, const char *timestamp, time_t now) {
+  if (slot->suppressed > 0) {
+    char text[512];
+    int length = snprintf(text, sizeof(text),
+                          "[%s] Error %d: %s (repeated %ld more times in %lld s)\nLocation: %s:%d\n\n",
+                          timestamp, slot->code, slot->message, slot->suppressed,
+                          (long long) (now - slot->window_start), slot->file, slot->line);
+    if (length >= (int) sizeof(text)) length = (int) sizeof(text) - 1;
+    error_log_write(text, length);
+    fprintf(stderr, "%.*s", length, text);
+  }
+  slot->window_start = now;
+  slot->count = 0;
+  slot->suppressed = 0;
+}
+
+static VOID CALLBACK on_reopen_event(PVOID context, BOOLEAN timed_out) {
+  (void) context;
+  (void) timed_out;
+  error_log_reopen();
+}
+
+// 외부 로그 교체 도구가 파일을 옮긴 뒤 SetEvent로 알리는 이벤트 (실패해도 내부 교체는 동작)
+static void reopen_trigger_start(void) {
+  if (reopen_event) return;
+
+  char name[64];
+  snprintf(name, sizeof(name), ERROR_LOG_REOPEN_EVENT, (unsigned long) GetCurrentProcessId());
+  reopen_event = CreateEventA(NULL, FALSE, FALSE, name);
+  if (!reopen_event) return;
+
+  if (!RegisterWaitForSingleObject(&reopen_wait, reopen_event, on_reopen_event, NULL,
+                                   INFINITE, WT_EXECUTEDEFAULT)) {
+    CloseHandle(reopen_event);
+    reopen_event = NULL;
+    return;
+  }
+  printf("Error log reopen event: %s\n", name);
+}
+
+static void reopen_trigger_stop(void) {
+  if (!reopen_event) return;
+  UnregisterWaitEx(reopen_wait, INVALID_HANDLE_VALUE); // 실행 중인 콜백이 끝날 때까지 대기
+  CloseHandle(reopen_event);
+  reopen_wait = NULL;
+  reopen_event = NULL;
+}
+
+int error_log_open(const char *path, size_t max_size, int rotate_interval) {
+  time_t now = time(NULL);
+
+  reopen_trigger_start();
+
+  AcquireSRWLockExclusive(&error_log.lock);
+  error_log_close_file(now);
+  snprintf(error_log.path, sizeof(error_log.path), "%s", path);
+  error_log.max_size = max_size;
+  error_log.rotate_interval = rotate_interval;
+  error_log.closed = 0;
+  int result = error_log_open_file(now);
+  ReleaseSRWLockExclusive(&error_log.lock);
+
+  return result;
+}
+
+void error_log_tick(void) {
+  time_t now = time(NULL);
+
+  AcquireSRWLockExclusive(&error_log.lock);
+  error_log_maintain(now);
+  for (int i = 0; i < ERROR_LOG_SLOTS; i++) {
+    error_log_slot *slot = &error_log.slots[i];
+    if (slot->suppressed > 0 && now - slot->window_start >= ERROR_LOG_RATE_WINDOW) {
+      error_log_summarize(slot, log_time_now(), now);
+    }
+  }
+  if (now != error_log.flushed_at) error_log_flush(now);
+  ReleaseSRWLockExclusive(&error_log.lock);
+}
+
+void error_log_reopen(void) {
+  InterlockedExchange(&reopen_requested, 1);
+}
+
+void error_log_close(void) {
+  time_t now = time(NULL);
+
+  reopen_trigger_stop();
+
+  AcquireSRWLockExclusive(&error_log.lock);
+  for (int i = 0; i < ERROR_LOG_SLOTS; i++) {
+    error_log_summarize(&error_log.slots[i], log_time_now(), now);
+  }
+  error_log_close_file(now);
+  error_log.closed = 1;
+  ReleaseSRWLockExclusive(&error_log.lock);
+}
+
+void log_error(const error_context *err) {
+  const char *timestamp = log_time_now();
+  time_t now = time(NULL);
+  unsigned long long key = error_key(err);
+
+  AcquireSRWLockExclusive(&error_log.lock);
+  error_log_maintain(now);
+
+  // 같은 위치, 코드, 메시지의 에러는 창마다 ERROR_LOG_BURST개까지만 기록
+  error_log_slot *slot = &error_log.slots[key & (ERROR_LOG_SLOTS - 1)];
+  if (slot->key != key) {
+    error_log_summarize(slot, timestamp, now); // 밀려나는 에러의 남은 횟수
+    slot->key = key;
+    slot->code = err->code;
+    slot->file = err->file;
+    slot->line = err->line;
+    snprintf(slot->message, sizeof(slot->message), "%s", err->message);
+  } else if (now - slot->window_start >= ERROR_LOG_RATE_WINDOW) {
+    error_log_summarize(slot, timestamp, now);
+  }
+
+  if (++slot->count > ERROR_LOG_BURST) {
+    slot->suppressed++;
+    ReleaseSRWLockExclusive(&error_log.lock);
+    return;
+  }
+
+  char text[2048];
+  int length = snprintf(text, sizeof(text), "[%s] Error %d: %s\n%s%s%sLocation: %s:%d\n\n",
+                        timestamp, err->code, err->message,
+                        err->detail ? "Detail: " : "", err->detail ? err->detail : "", err->detail ? "\n" : "",
+                        err->file, err->line);
+  if (length >= (int) sizeof(text)) length = (int) sizeof(text) - 1;
+  error_log_write(text, length);
+
+  // 틱이 오지 않는 동안에도 1초 넘게 버퍼에 남기지 않음
+  if (now != error_log.flushed_at) error_log_flush(now);
+  ReleaseSRWLockExclusive(&error_log.lock);
+
+  // 콘솔에도 출력
+  fprintf(stderr, "%.*s", length, text);
 }
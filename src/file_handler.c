@@ -12,10 +12,18 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <ctype.h>
-#include <server.h>
 #include <time.h>
 
 #include "error_handle.h"
+#include "file_watcher.h"
+#include "open_file_cache.h"
+#include "http_parser.h"
+#include "compress.h"
+#include "mime_types.h"
+#include "bundle.h"
+#include "response_header.h"
+#include "server.h"
+#include "logger.h"
 
 #ifdef _WIN32
 #include <stdlib.h>
@@ -26,614 +34,975 @@
 #endif
 
 static file_cache *cache = NULL;
-static const int CACHE_TTL = 300; // 5분 캐시 유효시간
-
-// MIME 타입 매핑
-static const mime_mapping MIME_TYPES[] = {
-    {".html", "text/html"},
-    {".htm", "text/html"},
-    {".css", "text/css"},
-    {".js", "application/javascript"},
-    {".json", "application/json"},
-    {".txt", "text/plain"},
-    {".jpg", "image/jpeg"},
-    {".jpeg", "image/jpeg"},
-    {".png", "image/png"},
-    {".gif", "image/gif"},
-    {".svg", "image/svg+xml"},
-    {".ico", "image/x-icon"},
-    {".pdf", "application/pdf"},
-    {".xml", "application/xml"},
-    {".zip", "application/zip"},
-    {NULL, "application/octet-stream"} // Default
-};
-
-// 유니코드 코드포인트를 UTF-8로 변환
-static int unicode_to_utf8(unsigned int code, char *dst) {
-    if (code <= 0x7F) {
-        dst[0] = (char) code;
-        return 1;
-    } else if (code <= 0x7FF) {
-        dst[0] = (char) (0xC0 | (code >> 6));
-        dst[1] = (char) (0x80 | (code & 0x3F));
-        return 2;
-    } else if (code <= 0xFFFF) {
-        dst[0] = (char) (0xE0 | (code >> 12));
-        dst[1] = (char) (0x80 | ((code >> 6) & 0x3F));
-        dst[2] = (char) (0x80 | (code & 0x3F));
-        return 3;
-    } else if (code <= 0x10FFFF) {
-        dst[0] = (char) (0xF0 | (code >> 18));
-        dst[1] = (char) (0x80 | ((code >> 12) & 0x3F));
-        dst[2] = (char) (0x80 | ((code >> 6) & 0x3F));
-        dst[3] = (char) (0x80 | (code & 0x3F));
-        return 4;
-    } else {
-        // 유효하지 않음
-        return -1;
+static const int CACHE_TTL = 300; // 5분 캐시 유효시간 (변경 감시가 없을 때만 적용)
+static volatile LONG cache_generation = 0; // 무효화 세대
+
+// 같은 키의 동시 캐시 미스는 먼저 온 요청 하나만 디스크에서 읽음 (나머지는 결과 대기)
+#define FLIGHT_BUCKET_COUNT 64
+
+typedef struct load_flight {
+    char *key; // 캐시 키
+    unsigned int hash;
+    int done; // 로더 완료 여부
+    cache_entry *entry; // 로더가 캐시에 넣은 엔트리 (실패 시 NULL, 비행 구조체가 참조 하나 보유)
+    int refs; // 로더 1 + 대기 중인 요청 수 (flight_lock 보호)
+    struct load_flight *next;
+} load_flight;
+
+static SRWLOCK flight_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE flight_done = CONDITION_VARIABLE_INIT;
+static load_flight *flight_buckets[FLIGHT_BUCKET_COUNT];
+static volatile LONG coalesced_waits = 0; // 다른 요청의 읽기를 기다려 결과를 공유한 횟수
+
+// document_root 디렉토리 핸들 (서버 실행 중 열어 두어 교체/이동 방지)
+static HANDLE docroot_handle = INVALID_HANDLE_VALUE;
+static char docroot_final_path[PATH_MAX]; // 핸들 기준 최종 경로
+static size_t docroot_final_len = 0; // 0이면 최종 경로 검사 불가 (컴포넌트 검사만 사용)
+
+// 거부 사유 문자열
+static const char *path_status_text(path_status status) {
+    switch (status) {
+        case PATH_OK: return "OK";
+        case PATH_EMPTY: return "Empty path rejected";
+        case PATH_TOO_LONG: return "Path too long";
+        case PATH_BAD_ENCODING: return "Invalid or double URL encoding in path";
+        case PATH_BAD_CHAR: return "Forbidden character in path";
+        case PATH_TRAVERSAL: return "Directory traversal attempt";
+        case PATH_HIDDEN: return "Hidden file access attempted";
+        default: return "Invalid path";
     }
 }
 
-// URL 디코딩
-static void url_decode(char *dst, const char *src) {
-    while (*src) {
-        if (*src == '%' && src[1] && src[2]) {
-            char a = src[1];
-            if ((a == 'u' || a == 'U') && src[2] && src[3] && src[4] && src[5]) {
-                // 유니코드 인코딩 처리 (%uXXXX)
-                if (isxdigit(src[2]) && isxdigit(src[3]) &&
-                    isxdigit(src[4]) && isxdigit(src[5])) {
-                    char code_str[5] = {src[2], src[3], src[4], src[5], '\0'};
-                    unsigned int code;
-                    sscanf(code_str, "%x", &code);
-                    // 유니코드 코드포인트 -> UTF-8로
-                    int len = unicode_to_utf8(code, dst);
-                    if (len > 0) {
-                        dst += len;
-                        src += 6; // '%uXXXX' 처리 후 이동
-                        continue;
-                    }
-                }
-            } else if (isxdigit(a) && isxdigit(src[2])) {
-                // 표준 URL 인코딩 처리 (%XX)
-                char b = src[2];
-                a = tolower(a);
-                b = tolower(b);
-                a = (a >= 'a') ? a - 'a' + 10 : a - '0';
-                b = (b >= 'a') ? b - 'a' + 10 : b - '0';
-                *dst++ = (char) (a * 16 + b);
-                src += 3;
-                continue;
-            }
-        } else if (*src == '+') {
-            *dst++ = ' ';
-            src++;
-        } else {
-            *dst++ = *src++;
-        }
+// 보안 검사
+int is_path_safe(const char *path) {
+    char canonical[PATH_MAX];
+    path_status status = canonicalize_path(path, canonical, sizeof(canonical));
+    if (status != PATH_OK) {
+        LOG_ERROR(path_status_text(status), path ? path : "(null)");
+        return 0;
     }
-    *dst = '\0';
+    return 1;
 }
 
-// 재귀적 디코딩 호출
-void recursive_url_decode(char *dst, const char *src) {
-    char temp[PATH_MAX];
-    strcpy(temp, src);
-    char decoded[PATH_MAX];
-    while (1) {
-        url_decode(decoded, temp);
-        if (strcmp(decoded, temp) == 0) break;
-        strcpy(temp, decoded);
+// document_root를 한 번만 열고 최종 경로 저장
+int docroot_init(const char *document_root) {
+    docroot_handle = CreateFile(document_root,
+                                GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS,
+                                NULL);
+    if (docroot_handle == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to open document root", document_root);
+        return -1;
     }
-    strcpy(dst, decoded);
-}
 
-// 보안 검사
-int is_path_safe(const char *path) {
-    if (!path || !*path) {
-        LOG_ERROR("Empty path rejected", "Path is null or empty");
+    DWORD len = GetFinalPathNameByHandle(docroot_handle,
+                                         docroot_final_path,
+                                         sizeof(docroot_final_path),
+                                         FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+    if (len == 0 || len >= sizeof(docroot_final_path)) {
+        // 최종 경로를 얻을 수 없는 환경은 컴포넌트 단위 검사로 대체
+        printf("Final path lookup unavailable, using component checks only\n");
+        docroot_final_len = 0;
         return 0;
     }
 
-    // URL 인코딩된 패턴, 기본 패턴 검사
-    if (strstr(path, "..") || strstr(path, "%2e%2e") || strstr(path, "%2E%2E") ||
-        strstr(path, "%u2e%u2e") || strstr(path, "%c0%2e") ||
-        strstr(path, "%u2215") || strstr(path, "%c0%af") ||
-        strstr(path, "%u002e") || strstr(path, "%u002E") ||
-        strstr(path, "%00") || strstr(path, "\\0") ||
-        strstr(path, "%5c") || strstr(path, "%2f") ||
-        strstr(path, "....")) {
-        LOG_ERROR("Path traversal pattern detected", path);
+    // 루트 자체가 드라이브 루트인 경우 끝 구분자 제거
+    while (len > 0 && docroot_final_path[len - 1] == '\\') {
+        docroot_final_path[--len] = '\0';
+    }
+    docroot_final_len = len;
+
+    printf("Document root resolved: %s\n", docroot_final_path);
+    return 0;
+}
+
+void docroot_cleanup(void) {
+    if (docroot_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(docroot_handle);
+        docroot_handle = INVALID_HANDLE_VALUE;
+    }
+    docroot_final_len = 0;
+}
+
+// 이미 열린 파일이 document_root 아래에 있는지 검사
+// 경로 문자열이 아니라 실제로 열린 객체 기준이므로 링크 교체 경쟁이 없음
+int docroot_contains(HANDLE file) {
+    if (docroot_final_len == 0) return 1;
+
+    char final_path[PATH_MAX];
+    DWORD len = GetFinalPathNameByHandle(file,
+                                         final_path,
+                                         sizeof(final_path),
+                                         FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+    if (len == 0 || len >= sizeof(final_path)) {
+        // 장치 이름(CON, NUL 등)처럼 최종 경로가 없는 객체는 거부
         return 0;
     }
 
-    // document_root 절대 경로
-    char doc_root_path[PATH_MAX];
-#ifdef _WIN32
-    if (!_fullpath(doc_root_path, g_server->config.document_root, PATH_MAX)) {
-#else
-    if (!realpath(g_server->config.document_root, doc_root_path)) {
-#endif
-        LOG_ERROR("Document root normalization failed", g_server->config.document_root);
+    if (_strnicmp(final_path, docroot_final_path, docroot_final_len) != 0 ||
+        final_path[docroot_final_len] != '\\') {
+        LOG_ERROR("Path outside document root", final_path);
         return 0;
     }
+    return 1;
+}
 
-    // URL 디코딩, 정규화
-    char decoded_path[PATH_MAX];
-    recursive_url_decode(decoded_path, path);
-    printf("Decoded Path: %s\n", decoded_path);
+// 요청 경로 검증 및 전체 경로 생성
+int resolve_request_path(const char *base_path, const char *request_path, char *out, size_t out_size) {
+    char canonical[PATH_MAX];
+    path_status status = canonicalize_path(request_path, canonical, sizeof(canonical));
+    if (status != PATH_OK) {
+        LOG_ERROR(path_status_text(status), request_path ? request_path : "(null)");
+        return 403;
+    }
 
-    // 경로 컴포넌트별 체크
-    char path_copy[PATH_MAX];
-    strncpy(path_copy, decoded_path, PATH_MAX - 1);
-    char *saveptr;
-    char *token = strtok_r(path_copy, "/\\", &saveptr);
-    int depth = 0;
+    // index.html 처리
+    const char *relative = canonical[0] ? canonical : "index.html";
 
-    while (token) {
-        // ".." 관련 변형 검사
-        if (strstr(token, "..") || strstr(token, "....")) {
-            LOG_ERROR("Path traversal component detected", token);
-            return 0;
-        }
+    int written = snprintf(out, out_size, "%s%c%s", base_path, PATH_SEPARATOR, relative);
+    if (written < 0 || (size_t) written >= out_size) {
+        LOG_ERROR(path_status_text(PATH_TOO_LONG), request_path);
+        return 403;
+    }
 
-        // 의심스러운 문자열 패턴 검사
-        size_t suspicious_count = 0;
-        size_t token_len = strlen(token);
-        for (size_t i = 0; i < token_len; i++) {
-            if (!isalnum(token[i]) && token[i] != '.' && token[i] != '-' && token[i] != '_') {
-                suspicious_count++;
-            }
-        }
-        if (suspicious_count > token_len / 2) {
-            LOG_ERROR("Suspicious token pattern detected", token);
-            return 0;
-        }
+    return 200;
+}
 
-        // 디렉토리 깊이 체크
-        if (strcmp(token, "..") == 0) {
-            depth--;
-            if (depth < 0) {
-                LOG_ERROR("Directory traversal attempt", decoded_path);
-                return 0;
-            }
-        } else if (strcmp(token, ".") != 0) {
-            depth++;
-        }
+// 인코딩별 Content-Encoding 토큰
+const char *encoding_name(content_encoding encoding) {
+    switch (encoding) {
+        case ENCODING_GZIP: return "gzip";
+        case ENCODING_BR: return "br";
+        default: return "identity";
+    }
+}
 
-        token = strtok_r(NULL, "/\\", &saveptr);
+// 인코딩별 사이드카 확장자
+const char *encoding_suffix(content_encoding encoding) {
+    switch (encoding) {
+        case ENCODING_GZIP: return ".gz";
+        case ENCODING_BR: return ".br";
+        default: return "";
     }
+}
 
-    // 슬래시 정규화, 연속된 슬래시 제거
-    char *src = decoded_path;
-    char *dst = decoded_path;
-    while (*src) {
-        if ((*src == '/' || *src == '\\') && (*(src + 1) == '/' || *(src + 1) == '\\')) {
-            src++;
-            continue;
-        }
-        if (*src == '/' || *src == '\\') {
-            *dst++ = PATH_SEPARATOR;
-        } else {
-            *dst++ = *src;
-        }
-        src++;
+// 클라이언트가 허용하고 빌드에 포함된 즉석 압축 인코딩 선택 (br 우선)
+static content_encoding select_dynamic_encoding(int accept_encodings) {
+    if ((accept_encodings & ACCEPT_ENCODING_BR) && compress_supported(ENCODING_BR)) {
+        return ENCODING_BR;
+    }
+    if ((accept_encodings & ACCEPT_ENCODING_GZIP) && compress_supported(ENCODING_GZIP)) {
+        return ENCODING_GZIP;
     }
-    *dst = '\0';
+    return ENCODING_IDENTITY;
+}
 
-    // 경로 결합, 절대 경로 변환
-    char combined_path[PATH_MAX];
-    snprintf(combined_path, sizeof(combined_path), "%s%c%s",
-             doc_root_path,
-             PATH_SEPARATOR,
-             decoded_path[0] == '/' || decoded_path[0] == '\\' ? decoded_path + 1 : decoded_path);
+// 클라이언트가 허용하고 사이드카가 있는 인코딩 선택 (br 우선)
+static content_encoding select_encoding(const open_file *file, int accept_encodings) {
+    if ((accept_encodings & ACCEPT_ENCODING_BR) && open_file_has_variant(file, ENCODING_BR)) {
+        return ENCODING_BR;
+    }
+    if ((accept_encodings & ACCEPT_ENCODING_GZIP) && open_file_has_variant(file, ENCODING_GZIP)) {
+        return ENCODING_GZIP;
+    }
+    return ENCODING_IDENTITY;
+}
 
-    printf("Combined Path: %s\n", combined_path);
+// 사이드카가 없는 텍스트 파일은 즉석 압축 표현 선택
+// 메타데이터만으로 결정해 캐시 상태와 관계없이 HEAD와 GET이 같은 표현을 받음
+// (스트리밍 크기 이상은 압축하지 않음)
+static void select_dynamic_representation(file_result *result, int accept_encodings) {
+    if (result->encoding != ENCODING_IDENTITY) return;
+    if (!g_server || !g_server->config.compress_dynamic) return;
+    if (result->size < g_server->config.compress_min_size) return;
+    if (result->size >= g_server->config.stream_min_size) return;
+    if (!is_compressible_type(result->content_type)) return;
 
-    char absolute_path[PATH_MAX];
-#ifdef _WIN32
-    if (!_fullpath(absolute_path, combined_path, PATH_MAX)) {
-#else
-    if (!realpath(combined_path, absolute_path)) {
-#endif
-        LOG_ERROR("Path normalization failed", combined_path);
-        return 0;
-    }
+    // 이 빌드에서 쓸 수 있는 압축이 없으면 표현이 하나뿐이므로 Vary 불필요
+    if (!compress_supported(ENCODING_BR) && !compress_supported(ENCODING_GZIP)) return;
 
-    printf("Absolute Path: %s\n", absolute_path);
+    // 이 클라이언트의 압축 여부와 관계없이 표현이 Accept-Encoding에 따라 달라짐
+    result->varies = 1;
 
-    // document_root 외부 접근 시도 체크
-    size_t root_len = strlen(doc_root_path);
-    if (strncmp(absolute_path, doc_root_path, root_len) != 0 ||
-        (absolute_path[root_len] != PATH_SEPARATOR && absolute_path[root_len] != '\0')) {
-        LOG_ERROR("Path outside document root", absolute_path);
-        return 0;
-    }
+    result->encoding = select_dynamic_encoding(accept_encodings);
+    result->dynamic = result->encoding != ENCODING_IDENTITY;
+}
+
+static void set_etag(file_result *result);
+static void release_file_data(char *data, int mapped);
+
+// 읽은 원본을 즉석 압축 표현으로 교체 (캐시 엔트리가 있으면 엔트리의 압축본 공유)
+// 압축 이득이 없으면 원본 표현으로 되돌림 (내용으로만 결정되므로 HEAD와 GET이 같음)
+static void apply_dynamic_compression(file_result *result) {
+    if (!result->dynamic || !result->data) return;
 
-    // 숨김 파일 검사
-    const char *filename = strrchr(absolute_path, PATH_SEPARATOR);
-    if (filename) {
-        filename++; // 구분자 다음으로
+    if (result->cache_ref) {
+        const cache_variant *variant = cache_get_variant(result->cache_ref, result->encoding);
+        if (variant) {
+            result->data = (char *) variant->data;
+            result->size = variant->size;
+            return;
+        }
     } else {
-        filename = absolute_path;
-    }
-    if (filename[0] == '.') {
-        LOG_ERROR("Hidden file access attempted", filename);
-        return 0;
+        char *compressed = NULL;
+        size_t compressed_len = 0;
+        if (compress_buffer(result->encoding, result->data, result->size, &compressed, &compressed_len) == 0) {
+            release_file_data(result->data, result->mapped);
+            result->data = compressed;
+            result->size = compressed_len;
+            result->mapped = 0;
+            return;
+        }
     }
 
-    return 1;
+    result->encoding = ENCODING_IDENTITY;
+    result->dynamic = 0;
+    set_etag(result);
 }
 
-// 파일 확장자 추출
-static const char *get_file_extension(const char *file_path) {
-    const char *dot = strrchr(file_path, '.');
-    if (!dot || dot == file_path) {
-        return "";
+// 파일 데이터 해제 (매핑 뷰면 UnmapViewOfFile)
+static void release_file_data(char *data, int mapped) {
+    if (mapped) {
+        UnmapViewOfFile(data);
+    } else {
+        free(data);
     }
-    return dot;
 }
 
-// MIME 타입 얻기
-const char *get_mime_type(const char *file_path) {
-    printf("\n=== MIME Type Detection ===\n");
-    printf("File path: %s\n", file_path);
+// 표현의 ETag 설정 (파일 메타데이터 기반, 캐시 여부와 무관)
+// 압축 표현은 인코딩 접미사, 즉석 압축은 원본 크기 기준
+static void set_etag(file_result *result) {
+    const open_file *file = result->file_ref;
+    if (!file) return;
+
+    content_encoding stored = result->dynamic ? ENCODING_IDENTITY : result->encoding;
+    snprintf(result->etag, sizeof(result->etag), "\"%llx-%llx-%llx%s%s\"",
+             file->file_id,
+             file->mtime_ticks,
+             open_file_size(file, stored),
+             result->encoding != ENCODING_IDENTITY ? "-" : "",
+             result->encoding != ENCODING_IDENTITY ? encoding_name(result->encoding) : "");
+}
+
+// 캐시 엔트리를 결과 데이터로 사용 (호출자가 획득한 참조는 결과가 가져감)
+static void use_cache_entry(file_result *result, cache_entry *entry) {
+    result->data = entry->data;
+    result->size = entry->size;
+    result->content_type = entry->content_type;
+    result->cache_ref = entry;
+    apply_dynamic_compression(result);
+}
+
+// 캐시 키 (사이드카 표현은 사이드카 경로, 즉석 압축은 원본 경로)
+static void format_cache_key(char *key, size_t key_size, const file_result *result) {
+    const open_file *file = result->file_ref;
+    snprintf(key, key_size, "%s%s", file->path, result->dynamic ? "" : encoding_suffix(result->encoding));
+}
+
+// 메타데이터 조회 (캐시 히트가 아니면 data는 NULL)
+file_result lookup_file(const char *base_path, const char *request_path, int accept_encodings) {
+    file_result result = {.status_code = 404, .encoding = ENCODING_IDENTITY};
+
+    LOG_DEBUG("=== File Read Operation ===");
+    LOG_DEBUG("Request path: %s", request_path);
 
-    const char *extension = get_file_extension(file_path);
-    printf("Extension: %s\n", extension);
+    // 번들에 있으면 경로 검증, stat, open 없이 매핑된 뷰에서 응답
+    if (bundle_lookup(request_path, accept_encodings, &result)) {
+        LOG_DEBUG("Bundle hit: %s", request_path);
+        return result;
+    }
 
-    // 확장자가 없는 경우
-    if (!extension || !*extension) {
-        printf("No extension found\n");
-        return "application/octet-stream; charset=utf-8";
+    // 열린 파일 캐시 (히트 시 경로 검증, stat, open 모두 생략)
+    int cache_hit = 0;
+    open_file *file = open_file_cache_get(base_path, request_path, &cache_hit);
+    if (!file) {
+        result.status_code = 500;
+        result.error_detail = "Could not allocate file handle entry";
+        return result;
+    }
+    if (file->status_code != 200) {
+        result.status_code = file->status_code;
+        result.negative_hit = cache_hit;
+        open_file_release(file);
+        return result;
     }
+    result.file_ref = file;
+    result.varies = file->has_variants;
+    result.last_modified = file->http_date;
+    result.mtime = file->mtime;
+    result.status_code = 200;
 
-    // 확장자를 소문자로
-    char ext_lower[32];
-    strncpy(ext_lower, extension, sizeof(ext_lower) - 1);
-    ext_lower[sizeof(ext_lower) - 1] = '\0';
+    // MIME 타입 설정 (압축 표현도 원본 타입)
+    result.content_type = get_mime_type(file->path);
 
-    for (char *p = ext_lower; *p; p++) {
-        *p = tolower(*p);
+    // 표현 선택 (사이드카, 없으면 즉석 압축), ETag도 메타데이터로 미리 결정
+    result.encoding = select_encoding(file, accept_encodings);
+    result.size = (size_t) open_file_size(file, result.encoding);
+    select_dynamic_representation(&result, accept_encodings);
+    set_etag(&result);
+
+    // 캐시 확인
+    char cache_key[PATH_MAX];
+    format_cache_key(cache_key, sizeof(cache_key), &result);
+
+    cache_entry *cached = cache_get(cache_key);
+    if (cached) {
+        LOG_DEBUG("Cache hit: %s", cache_key);
+        use_cache_entry(&result, cached); // 획득한 참조는 free_file_result에서 반납
     }
-    printf("Normalized extension: %s\n", ext_lower);
+    return result;
+}
 
-    // MIME 타입 검색
-    for (const mime_mapping *mime = MIME_TYPES; mime->extension != NULL; mime++) {
-        printf("Comparing with: %s -> %s\n", mime->extension, mime->mime_type);
-        if (strcmp(ext_lower, mime->extension) == 0) {
-            // 텍스트 기반 파일의 경우 UTF-8 인코딩
-            if (strstr(mime->mime_type, "text/") == mime->mime_type ||
-                strstr(mime->mime_type, "application/json") == mime->mime_type ||
-                strstr(mime->mime_type, "application/javascript") == mime->mime_type) {
-                static char mime_with_charset[256];
-                snprintf(mime_with_charset,
-                         sizeof(mime_with_charset),
-                         "%s; charset=utf-8",
-                         mime->mime_type);
-                printf("Found MIME type: %s\n", mime_with_charset);
-                return mime_with_charset;
-            }
-            printf("Found MIME type: %s\n", mime->mime_type);
-            return mime->mime_type;
+static unsigned int hash_path(const char *path);
+
+// 진행 중인 읽기 참가 (로더면 1, 대기 후 공유 엔트리를 받으면 0)
+static int flight_join(const char *key, load_flight **out, cache_entry **shared) {
+    unsigned int hash = hash_path(key);
+    load_flight **bucket = &flight_buckets[hash % FLIGHT_BUCKET_COUNT];
+
+    AcquireSRWLockExclusive(&flight_lock);
+    load_flight *flight = *bucket;
+    while (flight && (flight->hash != hash || _stricmp(flight->key, key) != 0)) {
+        flight = flight->next;
+    }
+
+    if (!flight) {
+        // 첫 요청이 로더 (할당 실패 시 단독으로 읽음)
+        flight = (load_flight *) calloc(1, sizeof(load_flight));
+        if (flight) flight->key = strdup(key);
+        if (flight && flight->key) {
+            flight->hash = hash;
+            flight->refs = 1;
+            flight->next = *bucket;
+            *bucket = flight;
+        } else if (flight) {
+            free(flight);
+            flight = NULL;
         }
+        ReleaseSRWLockExclusive(&flight_lock);
+        *out = flight;
+        return 1;
     }
 
-    printf("No matching MIME type found, using default\n");
-    return "application/octet-stream; charset=utf-8";
-}
+    flight->refs++;
+    InterlockedIncrement(&coalesced_waits);
+    while (!flight->done) {
+        SleepConditionVariableSRW(&flight_done, &flight_lock, INFINITE, 0);
+    }
 
-// 경로 정규화
-static void normalize_path(char *path) {
-    char *src = path;
-    char *dst = path;
+    // 비행 구조체가 참조를 쥐고 있는 동안 각자의 참조 획득
+    *shared = flight->entry;
+    if (*shared) InterlockedIncrement(&(*shared)->ref_count);
 
-    // 연속된 슬래시 제거
-    while (*src) {
-        if (*src == '/' || *src == '\\') {
-            *dst++ = PATH_SEPARATOR;
-            while (*src == '/' || *src == '\\') src++;
-        } else {
-            *dst++ = *src++;
-        }
+    int last = --flight->refs == 0;
+    ReleaseSRWLockExclusive(&flight_lock);
+
+    if (last) {
+        if (flight->entry) cache_release(flight->entry);
+        free(flight->key);
+        free(flight);
     }
-    *dst = '\0';
+    *out = NULL;
+    return 0;
 }
 
-// 파일 읽기
-file_result read_file(const char *base_path, const char *request_path) {
-    file_result result = {NULL, 0, NULL, 404, NULL};
+// 로더 완료 (대기 중인 요청을 깨우고 테이블에서 제거)
+static void flight_finish(load_flight *flight, cache_entry *entry) {
+    if (!flight) return;
+    if (entry) InterlockedIncrement(&entry->ref_count);
 
-    printf("\n=== File Read Operation ===\n");
-    printf("Base path: %s\n", base_path);
-    printf("Request path: %s\n", request_path);
+    AcquireSRWLockExclusive(&flight_lock);
+    load_flight **link = &flight_buckets[flight->hash % FLIGHT_BUCKET_COUNT];
+    while (*link != flight) link = &(*link)->next;
+    *link = flight->next;
 
-    // 경로 안전성 체크
-    if (!is_path_safe(request_path)) {
-        result.status_code = 403;
-        return result;
+    flight->entry = entry;
+    flight->done = 1;
+    int last = --flight->refs == 0;
+    ReleaseSRWLockExclusive(&flight_lock);
+    WakeAllConditionVariable(&flight_done);
+
+    if (last) {
+        if (entry) cache_release(entry);
+        free(flight->key);
+        free(flight);
     }
+}
 
-    // 경로 처리
-    const char *cleaned_path = request_path;
-    while (*cleaned_path == '/') {
-        cleaned_path++;
+// 디스크에서 데이터 읽기 (이미 있으면 아무것도 하지 않음)
+int load_file_data(file_result *result) {
+    if (result->status_code != 200 || result->data) return result->status_code == 200;
+
+    const open_file *file = result->file_ref;
+    content_encoding stored = result->dynamic ? ENCODING_IDENTITY : result->encoding;
+    char cache_key[PATH_MAX];
+    format_cache_key(cache_key, sizeof(cache_key), result);
+
+    // 같은 키를 읽는 요청이 있으면 그 결과를 공유
+    // (로더가 캐시에 넣지 못했으면 각자 읽음)
+    load_flight *flight = NULL;
+    cache_entry *shared = NULL;
+    if (!flight_join(cache_key, &flight, &shared) && shared) {
+        LOG_DEBUG("Coalesced load: %s", cache_key);
+        use_cache_entry(result, shared);
+        return 1;
     }
 
-    // index.html 처리
-    if (strlen(cleaned_path) == 0) {
-        cleaned_path = "index.html";
+    // 조회 이후 다른 요청이 이미 읽어 두었으면 캐시 사용
+    cache_entry *cached = cache_get(cache_key);
+    if (cached) {
+        flight_finish(flight, cached);
+        use_cache_entry(result, cached);
+        return 1;
     }
 
-    // 전체 경로 생성
-    char full_path[1024];
-    snprintf(full_path, sizeof(full_path), "%s%c%s", base_path, PATH_SEPARATOR, cleaned_path);
-    printf("Full path: %s\n", full_path);
+    // 읽는 도중 파일이 바뀌면 읽은 내용을 캐시하지 않음
+    LONG generation = cache_generation;
 
-    // 경로 정규화
-    char normalized_path[1024];
-    strncpy(normalized_path, full_path, sizeof(normalized_path) - 1);
-    normalize_path(normalized_path);
+    // 설정에 따라 큰 파일은 읽어서 복사하는 대신 파일 매핑 뷰 사용 (페이지 캐시 공유)
+    // 스트리밍 크기 이상은 통째로 매핑하지 않음 (호출자가 스트리밍)
+    if (g_server && g_server->config.cache_mmap &&
+        result->size >= g_server->config.cache_mmap_min_size &&
+        result->size < g_server->config.stream_min_size) {
+        result->data = (char *) open_file_map(file, stored, result->size);
+        result->mapped = result->data != NULL;
+    }
 
-    printf("Normalized path: %s\n", normalized_path);
+    if (!result->data) {
+        // 메모리 할당 (빈 파일도 유효한 포인터 유지)
+        result->data = (char *) malloc(result->size ? result->size : 1);
+        if (!result->data) {
+            LOG_WARN("Memory allocation failed for size: %zu", result->size);
+            flight_finish(flight, NULL);
+            result->status_code = 500;
+            result->error_detail = "Could not allocate buffer for file transfer";
+            return 0;
+        }
 
-    // 캐시 확인
-    cache_entry *cached = cache_get(normalized_path);
-    if (cached) {
-        printf("Cache hit: %s\n", normalized_path);
-        result.data = cached->data;
-        result.size = cached->size;
-        result.content_type = strdup(cached->content_type);
-        result.status_code = 200;
-        cached->ref_count++;
-        return result;
+        // 파일 읽기 (열린 핸들 재사용)
+        size_t bytes_read = open_file_read(file, stored, result->data, result->size, 0);
+        if (bytes_read != result->size) {
+            LOG_WARN("Read error. Expected: %zu, Got: %zu", result->size, bytes_read);
+            free(result->data);
+            result->data = NULL;
+            flight_finish(flight, NULL);
+            result->status_code = 500;
+            return 0;
+        }
     }
 
-    // 파일 존재 확인
-    struct stat file_stat;
-    if (stat(normalized_path, &file_stat) != 0) {
-        printf("File not found: %s (errno: %d)\n", normalized_path, errno);
-        result.status_code = 404;
-        return result;
+    // 캐시에 저장, 버퍼 소유권은 캐시 엔트리로 넘어감
+    cache_entry *entry = NULL;
+    if (generation == cache_generation) {
+        entry = cache_put(cache_key, result);
+        if (entry) result->cache_ref = entry;
     }
-    printf("File found. Size: %lld bytes\n", (long long) file_stat.st_size);
+    flight_finish(flight, entry);
+    apply_dynamic_compression(result);
 
-    // 파일 열기
-    FILE *file = fopen(normalized_path, "rb");
-    if (!file) {
-        printf("Failed to open file: %s (errno: %d)\n", normalized_path, errno);
-        // 접근 거부인지 파일 없음인지 확인
-        if (errno == EACCES) {
-            result.status_code = 403;
-        } else if (errno == ENOENT) {
-            result.status_code = 404;
-        } else {
-            result.status_code = 500;
-        }
-        return result;
-    }
+    return 1;
+}
 
-    // 파일 크기 설정
-    result.size = file_stat.st_size;
+// 파일 읽기
+file_result read_file(const char *base_path, const char *request_path, int accept_encodings) {
+    file_result result = lookup_file(base_path, request_path, accept_encodings);
+    load_file_data(&result);
+    return result;
+}
 
-    // 메모리 할당
-    result.data = (char *) malloc(result.size);
-    if (!result.data) {
-        printf("Memory allocation failed for size: %zu\n", result.size);
-        fclose(file);
-        result.status_code = 500;
-        result.error_detail = "Could not allocate buffer for file transfer";
-        return result;
+// 메모리 해제
+void free_file_result(file_result *result) {
+    if (!result) return;
+
+    if (result->cache_ref) {
+        // 캐시 데이터는 엔트리가 소유, 참조만 반납
+        cache_release(result->cache_ref);
+    } else if (result->data && !result->from_bundle) {
+        release_file_data(result->data, result->mapped); // 캐시되지 않은 경우 직접 해제
     }
 
-    // 파일 읽기
-    size_t bytes_read = fread(result.data, 1, result.size, file);
-    fclose(file);
+    open_file_release(result->file_ref);
 
-    if (bytes_read != result.size) {
-        printf("Read error. Expected: %zu, Got: %zu\n", result.size, bytes_read);
-        free(result.data);
-        result.data = NULL;
-        result.status_code = 500;
-        return result;
+    result->data = NULL;
+    result->content_type = NULL;
+    result->cache_ref = NULL;
+    result->file_ref = NULL;
+    result->size = 0;
+    result->header_block = NULL;
+}
+
+// 경로 해시 (FNV-1a, NTFS처럼 대소문자 구분 없이)
+// 요청 경로의 대소문자와 변경 알림의 디스크 대소문자가 달라도 같은 키로 취급
+static unsigned int hash_path(const char *path) {
+    unsigned int hash = 2166136261u;
+    while (*path) {
+        hash ^= (unsigned char) tolower((unsigned char) *path++);
+        hash *= 16777619u;
     }
+    return hash;
+}
 
-    // MIME 타입 설정
-    result.content_type = strdup(get_mime_type(request_path));
-    result.status_code = 200;
+// 해시로 샤드 선택 (상위 비트 사용, 하위 비트는 버킷 인덱스용)
+static cache_shard *get_shard(unsigned int hash) {
+    return &cache->shards[(hash >> 24) & (CACHE_SHARD_COUNT - 1)];
+}
 
-    // 캐시에 저장
-    if (result.status_code == 200) {
-        cache_put(normalized_path, &result);
+// 엔트리 메모리 해제 (참조가 모두 반납된 뒤에만 호출)
+static void free_cache_entry(cache_entry *entry) {
+    for (int i = 0; i < ENCODING_COUNT; i++) {
+        free(entry->variants[i]);
+        free(entry->headers[i]);
+        free(entry->inline_responses[i]);
     }
+    release_file_data(entry->data, entry->mapped);
+    free(entry->path);
+    free(entry);
+}
 
-    return result;
+// LRU 리스트에서 분리 (샤드 락 보유 상태)
+static void lru_unlink(cache_shard *shard, cache_entry *entry) {
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else shard->lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else shard->lru_tail = entry->lru_prev;
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
 }
 
-// 데이터 포인터로 캐시 엔트리 찾기
-static cache_entry *find_cache_entry(const void *data) {
-    if (!cache) return NULL;
+// LRU 리스트 맨 앞에 추가 (샤드 락 보유 상태)
+static void lru_push_front(cache_shard *shard, cache_entry *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = shard->lru_head;
+    if (shard->lru_head) shard->lru_head->lru_prev = entry;
+    shard->lru_head = entry;
+    if (!shard->lru_tail) shard->lru_tail = entry;
+}
 
-    for (size_t i = 0; i < cache->size; i++) {
-        if (cache->entries[i] && cache->entries[i]->data == data) {
-            return cache->entries[i];
+// 샤드에서 엔트리 분리 (샤드 락 보유 상태)
+// 메모리는 해제하지 않음, 호출자가 캐시 보유 참조를 반납해야 함
+static int shard_unlink(cache_shard *shard, cache_entry *entry) {
+    cache_entry **link = &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+    while (*link) {
+        if (*link == entry) {
+            *link = entry->hash_next;
+            entry->hash_next = NULL;
+            lru_unlink(shard, entry);
+            shard->size--;
+            return 1;
         }
+        link = &(*link)->hash_next;
+    }
+    return 0;
+}
+
+// 샤드에서 경로로 엔트리 검색 (샤드 락 보유 상태)
+static cache_entry *shard_find(const cache_shard *shard, const char *path, unsigned int hash) {
+    cache_entry *entry = shard->buckets[hash & (shard->bucket_count - 1)];
+    while (entry) {
+        if (entry->hash == hash && _stricmp(entry->path, path) == 0) {
+            return entry;
+        }
+        entry = entry->hash_next;
     }
     return NULL;
 }
 
-// 메모리 해제
-void free_file_result(file_result *result) {
-    if (!result) return;
+// 특정 엔트리가 아직 캐시에 있으면 제거
+static void cache_evict_entry(cache_entry *entry) {
+    cache_shard *shard = get_shard(entry->hash);
+    AcquireSRWLockExclusive(&shard->lock);
+    int unlinked = shard_unlink(shard, entry);
+    ReleaseSRWLockExclusive(&shard->lock);
 
-    cache_entry *entry = find_cache_entry(result->data);
-    if (entry) {
-        entry->ref_count--; // 참조 카운트 감소
-        if (entry->ref_count == 0) {
-            // 실제 메모리 해제는 캐시에서 제거될 때만
-            result->data = NULL;
+    // 캐시가 보유하던 참조 반납
+    if (unlinked) cache_release(entry);
+}
+
+// 압축 표현 가져오기, 없으면 한 번 압축해서 엔트리에 붙임
+const cache_variant *cache_get_variant(cache_entry *entry, content_encoding encoding) {
+    if (!entry || encoding <= ENCODING_IDENTITY || encoding >= ENCODING_COUNT) return NULL;
+
+    cache_variant *variant = entry->variants[encoding];
+    if (!variant) {
+        char *compressed = NULL;
+        size_t compressed_len = 0;
+
+        if (compress_buffer(encoding, entry->data, entry->size, &compressed, &compressed_len) == 0) {
+            variant = (cache_variant *) malloc(sizeof(cache_variant) + compressed_len);
+            if (variant) {
+                variant->size = compressed_len;
+                memcpy(variant->data, compressed, compressed_len);
+            }
+            free(compressed);
+            LOG_DEBUG("Compressed %s (%s): %zu -> %zu bytes",
+                      entry->path, encoding_name(encoding), entry->size, compressed_len);
+        } else {
+            // 압축 이득이 없음을 기록해 다시 시도하지 않음
+            variant = (cache_variant *) calloc(1, sizeof(cache_variant));
+        }
+        if (!variant) return NULL;
+
+        // 동시에 압축한 경우 먼저 붙인 것을 사용
+        cache_variant *existing = (cache_variant *) InterlockedCompareExchangePointer(
+            (PVOID volatile *) &entry->variants[encoding], variant, NULL);
+        if (existing) {
+            free(variant);
+            variant = existing;
         }
-    } else {
-        free(result->data); // 캐시되지 않은 경우 직접 해제
     }
 
-    free(result->content_type);
-    result->data = NULL;
-    result->content_type = NULL;
-    result->size = 0;
+    return variant->size ? variant : NULL;
 }
 
+const cache_header *cache_get_header(cache_entry *entry, const file_result *result) {
+    if (!entry || !result || result->cache_ref != entry || !result->last_modified) return NULL;
+
+    cache_header *block = entry->headers[result->encoding];
+    if (!block) {
+        char text[1024];
+        int length = format_header_block(text, sizeof(text),
+                                         entry->content_type,
+                                         (unsigned long long) result->size,
+                                         result->encoding != ENCODING_IDENTITY ? encoding_name(result->encoding) : NULL,
+                                         result->varies,
+                                         result->etag,
+                                         result->last_modified);
+        if (length < 0) return NULL;
+
+        block = (cache_header *) malloc(sizeof(cache_header) + length + 1);
+        if (!block) return NULL;
+        block->varies = result->varies;
+        block->length = (size_t) length;
+        memcpy(block->data, text, length + 1);
+
+        // 동시에 만든 경우 먼저 붙인 것을 사용
+        cache_header *existing = (cache_header *) InterlockedCompareExchangePointer(
+            (PVOID volatile *) &entry->headers[result->encoding], block, NULL);
+        if (existing) {
+            free(block);
+            block = existing;
+        }
+    }
+
+    // 사이드카 생성/삭제로 Vary가 달라졌으면 호출자가 직접 만듦
+    return block->varies == result->varies ? block : NULL;
+}
+
+const cache_header *cache_get_inline_response(cache_entry *entry, const file_result *result, size_t max_size) {
+    if (result->size > max_size) return NULL;
+
+    cache_header *block = entry ? entry->inline_responses[result->encoding] : NULL;
+    if (!block) {
+        const cache_header *header = cache_get_header(entry, result);
+        if (!header) return NULL;
+
+        // 헤더 블록에서 상태 줄을 빼고 빈 줄과 본문을 이어 붙임
+        size_t status_length = sizeof(STATUS_LINE_200) - 1;
+        size_t header_length = header->length - status_length;
+        size_t length = header_length + 2 + result->size;
+        block = (cache_header *) malloc(sizeof(cache_header) + length);
+        if (!block) return NULL;
+        block->varies = header->varies;
+        block->length = length;
+        memcpy(block->data, header->data + status_length, header_length);
+        memcpy(block->data + header_length, "\r\n", 2);
+        memcpy(block->data + header_length + 2, result->data, result->size);
+
+        cache_header *existing = (cache_header *) InterlockedCompareExchangePointer(
+            (PVOID volatile *) &entry->inline_responses[result->encoding], block, NULL);
+        if (existing) {
+            free(block);
+            block = existing;
+        }
+    }
+
+    return block->varies == result->varies ? block : NULL;
+}
+
+// 참조 반납, 마지막 참조였다면 메모리 해제
+void cache_release(cache_entry *entry) {
+    if (!entry) return;
+    if (InterlockedDecrement(&entry->ref_count) == 0) {
+        free_cache_entry(entry);
+    }
+}
 
 // 캐시 초기화
 void cache_init(size_t capacity) {
-    cache = (file_cache *) malloc(sizeof(file_cache));
-    cache->entries = (cache_entry **) calloc(capacity, sizeof(cache_entry *));
-    cache->paths = (char **) calloc(capacity, sizeof(char *));
-    cache->size = 0;
-    cache->capacity = capacity;
+    cache = (file_cache *) calloc(1, sizeof(file_cache));
+    if (!cache) return;
+
+    // 샤드별 용량과 버킷 수 (용량의 2배 이상인 2의 거듭제곱)
+    size_t shard_capacity = (capacity + CACHE_SHARD_COUNT - 1) / CACHE_SHARD_COUNT;
+    if (shard_capacity == 0) shard_capacity = 1;
+    size_t bucket_count = 1;
+    while (bucket_count < shard_capacity * 2) bucket_count <<= 1;
+
+    for (size_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard *shard = &cache->shards[i];
+        InitializeSRWLock(&shard->lock);
+        shard->buckets = (cache_entry **) calloc(bucket_count, sizeof(cache_entry *));
+        shard->bucket_count = bucket_count;
+        shard->capacity = shard_capacity;
+    }
+}
+
+size_t cache_capacity(void) {
+    return cache ? cache->shards[0].capacity * CACHE_SHARD_COUNT : 0;
+}
+
+void cache_print_stats(void) {
+    printf("Cache: %ld coalesced waits\n", (long) coalesced_waits);
 }
 
 // 캐시 정리
 void cache_cleanup(void) {
     if (!cache) return;
 
-    for (size_t i = 0; i < cache->size; i++) {
-        if (cache->entries[i]) {
-            free(cache->entries[i]->data);
-            free(cache->entries[i]->content_type);
-            free(cache->entries[i]);
-        }
-        if (cache->paths[i]) {
-            free(cache->paths[i]);
+    for (size_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard *shard = &cache->shards[i];
+        AcquireSRWLockExclusive(&shard->lock);
+        cache_entry *entry = shard->lru_head;
+        while (entry) {
+            cache_entry *next = entry->lru_next;
+            entry->hash_next = NULL;
+            entry->lru_prev = NULL;
+            entry->lru_next = NULL;
+            cache_release(entry);
+            entry = next;
         }
+        shard->lru_head = NULL;
+        shard->lru_tail = NULL;
+        shard->size = 0;
+        ReleaseSRWLockExclusive(&shard->lock);
+        free(shard->buckets);
     }
 
-    free(cache->entries);
-    free(cache->paths);
     free(cache);
     cache = NULL;
 }
 
-// 캐시에서 파일 찾기
+// 캐시에서 파일 찾기 (참조 획득)
 cache_entry *cache_get(const char *path) {
     if (!cache) {
-        printf("Cache not initialized!\n");
+        LOG_WARN("Cache not initialized!");
+        return NULL;
+    }
+
+    unsigned int hash = hash_path(path);
+    cache_shard *shard = get_shard(hash);
+
+    LOG_DEBUG("=== Cache Lookup ===");
+    LOG_DEBUG("Looking for path: %s", path);
+
+    AcquireSRWLockExclusive(&shard->lock);
+    cache_entry *entry = shard_find(shard, path, hash);
+    if (entry) {
+        InterlockedIncrement(&entry->ref_count);
+        lru_unlink(shard, entry);
+        lru_push_front(shard, entry);
+    }
+    ReleaseSRWLockExclusive(&shard->lock);
+
+    if (!entry) {
+        LOG_DEBUG("Cache miss!");
         return NULL;
     }
 
+    // 변경 감시 중이면 무효화는 감시 스레드가 담당, 시스템 콜 없이 반환
+    if (file_watcher_active()) {
+        LOG_DEBUG("Cache hit! Entry size: %zu bytes", entry->size);
+        return entry;
+    }
+
+    // 유효성 검사는 락 밖에서 (stat 동안 샤드를 막지 않도록)
     time_t current_time = time(NULL);
-    printf("\n=== Cache Lookup ===\n");
-    printf("Looking for path: %s\n", path);
-    printf("Current cache size: %zu/%zu\n", cache->size, cache->capacity);
-
-    for (size_t i = 0; i < cache->size; i++) {
-        printf("Comparing with cached path: %s\n", cache->paths[i]);
-        if (strcmp(cache->paths[i], path) == 0) {
-            cache_entry *entry = cache->entries[i];
-            printf("Cache hit! Entry found.\n");
-            printf("Entry size: %zu bytes\n", entry->size);
-            printf("Time in cache: %lld seconds\n", current_time - entry->cached_time);
-
-            // 캐시 유효성 검사 (TTL)
-            if (current_time - entry->cached_time > CACHE_TTL) {
-                printf("Cache entry expired (TTL: %d seconds)\n", CACHE_TTL);
-                cache_remove(path);
-                return NULL;
-            }
+    LOG_DEBUG("Cache hit! Entry size: %zu bytes, time in cache: %lld seconds",
+              entry->size, (long long) (current_time - entry->cached_time));
+
+    // 캐시 유효성 검사 (TTL)
+    if (current_time - entry->cached_time > CACHE_TTL) {
+        LOG_DEBUG("Cache entry expired (TTL: %d seconds)", CACHE_TTL);
+        cache_evict_entry(entry);
+        cache_release(entry);
+        return NULL;
+    }
 
-            // 파일 변경 확인
-            struct stat st;
-            if (stat(path, &st) == 0) {
-                if (st.st_mtime > entry->last_modified) {
-                    printf("File modified since cached\n");
-                    cache_remove(path);
-                    return NULL;
-                }
-            }
-            printf("Cache entry valid and returned\n");
-            return entry;
-        }
+    // 파일 변경 확인
+    struct stat st;
+    if (stat(path, &st) == 0 && st.st_mtime > entry->last_modified) {
+        LOG_DEBUG("File modified since cached");
+        cache_evict_entry(entry);
+        cache_release(entry);
+        return NULL;
     }
 
-    printf("Cache miss!\n");
-    return NULL;
+    return entry;
 }
 
 // 캐시에 파일 추가 (LRU 방식)
-void cache_put(const char *path, const file_result *result) {
+cache_entry *cache_put(const char *path, const file_result *result) {
     if (!cache || !result || !result->data) {
-        printf("Invalid cache put attempt!\n");
-        return;
+        LOG_WARN("Invalid cache put attempt!");
+        return NULL;
     }
 
-    printf("\n=== Cache Put Operation ===\n");
-    printf("Adding file: %s\n", path);
-    printf("File size: %zu bytes\n", result->size);
-    printf("Current cache size: %zu/%zu\n", cache->size, cache->capacity);
-
-    // 캐시가 꽉 찬 경우 가장 오래된 항목 제거
-    if (cache->size == cache->capacity) {
-        printf("Cache full, removing oldest entry: %s\n", cache->paths[0]);
-        cache_remove(cache->paths[0]);
-    }
+    LOG_DEBUG("=== Cache Put Operation ===");
+    LOG_DEBUG("Adding file: %s (%zu bytes)", path, result->size);
 
-    // 새 엔트리 생성
-    cache_entry *entry = (cache_entry *) malloc(sizeof(cache_entry));
+    // 새 엔트리 생성 (락 밖에서 할당)
+    cache_entry *entry = (cache_entry *) calloc(1, sizeof(cache_entry));
     if (!entry) {
-        printf("Failed to allocate cache entry!\n");
-        return;
+        LOG_WARN("Failed to allocate cache entry!");
+        return NULL;
     }
 
-    entry->data = malloc(result->size);
-    if (!entry->data) {
-        printf("Failed to allocate cache data!\n");
-        free(entry);
-        return;
+    entry->path = strdup(path);
+    if (!entry->path) {
+        LOG_WARN("Failed to allocate cache data!");
+        free_cache_entry(entry);
+        return NULL;
     }
 
-    // 데이터 복사 시작
-    printf("Copying %zu bytes to cache...\n", result->size);
-    memcpy(entry->data, result->data, result->size);
+    // 데이터는 복사하지 않고 읽은 버퍼(또는 매핑 뷰)를 그대로 넘겨받음
+    entry->data = result->data;
+    entry->mapped = result->mapped;
+    entry->content_type = result->content_type;
     entry->size = result->size;
-    entry->content_type = strdup(result->content_type);
     entry->cached_time = time(NULL);
-    entry->ref_count = 1;
+    entry->ref_count = 2; // 캐시 보유분 + 호출자 참조
+    entry->hash = hash_path(path);
 
+    // 수정 시간은 조회 결과에 있으면 재사용
     struct stat st;
-    if (stat(path, &st) == 0) {
+    if (result->last_modified) {
+        entry->last_modified = result->mtime;
+    } else if (stat(path, &st) == 0) {
         entry->last_modified = st.st_mtime;
     }
 
-    // 캐시에 추가
-    size_t idx = cache->size;
-    cache->entries[idx] = entry;
-    cache->paths[idx] = strdup(path);
-    cache->size++;
+    cache_shard *shard = get_shard(entry->hash);
+    cache_entry *replaced = NULL;
+    cache_entry *evicted = NULL;
+
+    AcquireSRWLockExclusive(&shard->lock);
+
+    // 같은 경로의 기존 엔트리 교체
+    replaced = shard_find(shard, path, entry->hash);
+    if (replaced) shard_unlink(shard, replaced);
+
+    // 샤드가 꽉 찬 경우 가장 오래 전에 사용된 항목 제거
+    if (shard->size >= shard->capacity && shard->lru_tail) {
+        evicted = shard->lru_tail;
+        shard_unlink(shard, evicted);
+    }
+
+    size_t idx = entry->hash & (shard->bucket_count - 1);
+    entry->hash_next = shard->buckets[idx];
+    shard->buckets[idx] = entry;
+    lru_push_front(shard, entry);
+    shard->size++;
+
+    ReleaseSRWLockExclusive(&shard->lock);
 
-    printf("File successfully cached\n");
-    printf("New cache size: %zu/%zu\n", cache->size, cache->capacity);
+    // 제거된 엔트리는 전송 중인 요청이 없을 때 해제됨
+    if (replaced) cache_release(replaced);
+    if (evicted) {
+        LOG_DEBUG("Cache shard full, evicted: %s", evicted->path);
+        cache_release(evicted);
+    }
+
+    LOG_DEBUG("File successfully cached");
+    return entry;
 }
 
 // 캐시에서 파일 제거
 void cache_remove(const char *path) {
     if (!cache) return;
 
-    for (size_t i = 0; i < cache->size; i++) {
-        if (strcmp(cache->paths[i], path) == 0) {
-            // 메모리 해제
-            free(cache->entries[i]->data);
-            free(cache->entries[i]->content_type);
-            free(cache->entries[i]);
-            free(cache->paths[i]);
-
-            // 배열 정리
-            for (size_t j = i; j < cache->size - 1; j++) {
-                cache->entries[j] = cache->entries[j + 1];
-                cache->paths[j] = cache->paths[j + 1];
+    unsigned int hash = hash_path(path);
+    cache_shard *shard = get_shard(hash);
+
+    AcquireSRWLockExclusive(&shard->lock);
+    cache_entry *entry = shard_find(shard, path, hash);
+    if (entry) shard_unlink(shard, entry);
+    ReleaseSRWLockExclusive(&shard->lock);
+
+    // 목록에서만 분리, 마지막 참조가 반납될 때 해제
+    if (entry) cache_release(entry);
+}
+
+// 파일 변경으로 인한 무효화
+void cache_invalidate(const char *path) {
+    InterlockedIncrement(&cache_generation);
+    open_file_cache_invalidate(path);
+    cache_remove(path);
+}
+
+// 디렉토리 하위 엔트리 전체 무효화 (디렉토리 이동/삭제)
+void cache_invalidate_prefix(const char *dir_path) {
+    if (!cache) return;
+
+    InterlockedIncrement(&cache_generation);
+    open_file_cache_clear(); // 디렉토리 단위 변경은 드물어 열린 파일은 전부 닫음
+    size_t len = strlen(dir_path);
+
+    for (size_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard *shard = &cache->shards[i];
+        cache_entry *removed = NULL;
+
+        AcquireSRWLockExclusive(&shard->lock);
+        cache_entry *entry = shard->lru_head;
+        while (entry) {
+            cache_entry *next = entry->lru_next;
+            if (_strnicmp(entry->path, dir_path, len) == 0 && entry->path[len] == PATH_SEPARATOR) {
+                shard_unlink(shard, entry);
+                // 분리된 엔트리는 hash_next로 묶어 락 밖에서 반납
+                entry->hash_next = removed;
+                removed = entry;
             }
+            entry = next;
+        }
+        ReleaseSRWLockExclusive(&shard->lock);
 
-            cache->size--;
-            return;
+        while (removed) {
+            cache_entry *next = removed->hash_next;
+            cache_release(removed);
+            removed = next;
+        }
+    }
+}
+
+// 캐시 전체 무효화
+void cache_clear(void) {
+    if (!cache) return;
+
+    InterlockedIncrement(&cache_generation);
+    open_file_cache_clear();
+
+    for (size_t i = 0; i < CACHE_SHARD_COUNT; i++) {
+        cache_shard *shard = &cache->shards[i];
+
+        AcquireSRWLockExclusive(&shard->lock);
+        cache_entry *removed = shard->lru_head;
+        for (cache_entry *entry = removed; entry; entry = entry->lru_next) {
+            entry->hash_next = NULL;
+        }
+        memset(shard->buckets, 0, shard->bucket_count * sizeof(cache_entry *));
+        shard->lru_head = NULL;
+        shard->lru_tail = NULL;
+        shard->size = 0;
+        ReleaseSRWLockExclusive(&shard->lock);
+
+        while (removed) {
+            cache_entry *next = removed->lru_next;
+            removed->lru_prev = NULL;
+            removed->lru_next = NULL;
+            cache_release(removed);
+            removed = next;
         }
     }
 }
@@ -0,0 +1,237 @@
+/*
+ * 대용량 파일 스트리밍 읽기
+ * - ReOpenFile로 같은 파일 객체를 FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED로 열기
+ *   (경로를 다시 찾지 않으므로 검증된 파일 그대로, 순차 힌트로 캐시 관리자가 미리 읽기)
+ * - 블록마다 ReadFile을 미리 걸어 두고, 소비한 블록은 바로 다음 구간 읽기에 재사용
+ * - 커널 전송 모드는 블록 없이 같은 핸들을 TransmitFile에 넘김 (사용자 공간 복사 없음)
+ */
+
+#include "file_stream.h"
+#include "open_file_cache.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <mswsock.h>
+
+typedef struct {
+  OVERLAPPED overlapped; // 읽기 위치와 완료 이벤트
+  char *buffer; // 풀에서 빌린 블록
+  DWORD requested; // 요청한 바이트 수
+  int pending; // 읽기가 걸려 있는지
+} stream_block;
+
+struct file_stream {
+  HANDLE handle; // overlapped 모드 핸들
+  unsigned long long next_offset; // 다음에 요청할 위치
+  unsigned long long end; // 구간 끝 (제외)
+  stream_block blocks[STREAM_DEPTH];
+  int current; // 다음에 소비할 블록
+  int in_use; // 호출자에게 넘겨준 블록 (-1이면 없음)
+  int failed; // 읽기 에러
+};
+
+// 블록 풀 (전송이 끝나도 블록을 해제하지 않고 재사용)
+static SRWLOCK pool_lock = SRWLOCK_INIT;
+static char *pool_blocks[STREAM_POOL_MAX];
+static size_t pool_count = 0;
+
+static char *pool_acquire(void) {
+  char *block = NULL;
+  AcquireSRWLockExclusive(&pool_lock);
+  if (pool_count > 0) {
+    block = pool_blocks[--pool_count];
+  }
+  ReleaseSRWLockExclusive(&pool_lock);
+  return block ? block : (char *) malloc(STREAM_BLOCK_SIZE);
+}
+
+static void pool_release(char *block) {
+  if (!block) return;
+  AcquireSRWLockExclusive(&pool_lock);
+  if (pool_count < STREAM_POOL_MAX) {
+    pool_blocks[pool_count++] = block;
+    block = NULL;
+  }
+  ReleaseSRWLockExclusive(&pool_lock);
+  free(block);
+}
+
+void file_stream_pool_cleanup(void) {
+  AcquireSRWLockExclusive(&pool_lock);
+  while (pool_count > 0) {
+    free(pool_blocks[--pool_count]);
+  }
+  ReleaseSRWLockExclusive(&pool_lock);
+}
+
+// 다음 구간 읽기 요청 (구간 끝이면 아무것도 하지 않음)
+static void issue_read(file_stream *stream, stream_block *block) {
+  block->pending = 0;
+  if (stream->failed || stream->next_offset >= stream->end) return;
+
+  unsigned long long remaining = stream->end - stream->next_offset;
+  block->requested = (DWORD) (remaining < STREAM_BLOCK_SIZE ? remaining : STREAM_BLOCK_SIZE);
+  block->overlapped.Internal = 0;
+  block->overlapped.InternalHigh = 0;
+  block->overlapped.Offset = (DWORD) (stream->next_offset & 0xFFFFFFFF);
+  block->overlapped.OffsetHigh = (DWORD) (stream->next_offset >> 32);
+
+  if (!ReadFile(stream->handle, block->buffer, block->requested, NULL, &block->overlapped) &&
+      GetLastError() != ERROR_IO_PENDING) {
+    LOG_WARN("Stream read failed at %llu: %lu", stream->next_offset, GetLastError());
+    stream->failed = 1;
+    return;
+  }
+
+  block->pending = 1;
+  stream->next_offset += block->requested;
+}
+
+// 구간과 overlapped 핸들만 준비 (블록 없음)
+static file_stream *stream_create(const open_file *file,
+                                  content_encoding encoding,
+                                  unsigned long long offset,
+                                  unsigned long long length) {
+  if (!file || file->status_code != 200) return NULL;
+
+  HANDLE source = encoding == ENCODING_IDENTITY ? file->handle : file->variants[encoding].handle;
+  if (source == INVALID_HANDLE_VALUE) return NULL;
+
+  file_stream *stream = (file_stream *) calloc(1, sizeof(file_stream));
+  if (!stream) return NULL;
+
+  stream->handle = ReOpenFile(source,
+                              GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED);
+  if (stream->handle == INVALID_HANDLE_VALUE) {
+    free(stream);
+    return NULL;
+  }
+
+  stream->next_offset = offset;
+  stream->end = offset + length;
+  stream->in_use = -1;
+  return stream;
+}
+
+file_stream *file_stream_open(const open_file *file,
+                              content_encoding encoding,
+                              unsigned long long offset,
+                              unsigned long long length) {
+  file_stream *stream = stream_create(file, encoding, offset, length);
+  if (!stream) return NULL;
+
+  for (int i = 0; i < STREAM_DEPTH; i++) {
+    stream_block *block = &stream->blocks[i];
+    block->buffer = pool_acquire();
+    block->overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!block->buffer || !block->overlapped.hEvent) {
+      file_stream_close(stream);
+      return NULL;
+    }
+  }
+
+  // 처음 STREAM_DEPTH개 블록 읽기 시작
+  for (int i = 0; i < STREAM_DEPTH; i++) {
+    issue_read(stream, &stream->blocks[i]);
+  }
+  if (stream->failed) {
+    file_stream_close(stream);
+    return NULL;
+  }
+
+  return stream;
+}
+
+const char *file_stream_next(file_stream *stream, size_t *length) {
+  *length = 0;
+
+  // 앞서 넘겨준 블록은 다 보냈으므로 다음 구간 읽기에 사용
+  if (stream->in_use >= 0) {
+    issue_read(stream, &stream->blocks[stream->in_use]);
+    stream->in_use = -1;
+  }
+
+  stream_block *block = &stream->blocks[stream->current];
+  if (!block->pending) return NULL;
+
+  DWORD bytes_read = 0;
+  BOOL ok = GetOverlappedResult(stream->handle, &block->overlapped, &bytes_read, TRUE);
+  block->pending = 0;
+  if (!ok || bytes_read != block->requested) {
+    // 전송 중 파일이 잘렸거나 읽기 실패
+    LOG_WARN("Stream read incomplete: %lu of %lu bytes", bytes_read, block->requested);
+    stream->failed = 1;
+    return NULL;
+  }
+
+  stream->in_use = stream->current;
+  stream->current = (stream->current + 1) % STREAM_DEPTH;
+  *length = bytes_read;
+  return block->buffer;
+}
+
+file_stream *file_stream_open_transmit(const open_file *file,
+                                       content_encoding encoding,
+                                       unsigned long long offset,
+                                       unsigned long long length) {
+  return stream_create(file, encoding, offset, length);
+}
+
+int file_stream_transmit(file_stream *stream, SOCKET socket) {
+  OVERLAPPED overlapped = {0};
+  overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if (!overlapped.hEvent) {
+    stream->failed = 1;
+    return -1;
+  }
+
+  // 한 번에 보낼 수 있는 크기가 DWORD라 큰 구간은 나눠 전송
+  while (stream->next_offset < stream->end) {
+    unsigned long long remaining = stream->end - stream->next_offset;
+    DWORD length = (DWORD) (remaining < TRANSMIT_CHUNK_MAX ? remaining : TRANSMIT_CHUNK_MAX);
+    overlapped.Internal = 0;
+    overlapped.InternalHigh = 0;
+    overlapped.Offset = (DWORD) (stream->next_offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD) (stream->next_offset >> 32);
+    ResetEvent(overlapped.hEvent);
+
+    DWORD sent = 0;
+    DWORD flags = 0;
+    if ((!TransmitFile(socket, stream->handle, length, 0, &overlapped, NULL, 0) &&
+         WSAGetLastError() != WSA_IO_PENDING) ||
+        !WSAGetOverlappedResult(socket, &overlapped, &sent, TRUE, &flags)) {
+      LOG_WARN("TransmitFile failed at %llu: %d", stream->next_offset, WSAGetLastError());
+      stream->failed = 1;
+      break;
+    }
+    stream->next_offset += length;
+  }
+
+  CloseHandle(overlapped.hEvent);
+  return stream->failed ? -1 : 0;
+}
+
+int file_stream_failed(const file_stream *stream) {
+  return stream ? stream->failed : 1;
+}
+
+void file_stream_close(file_stream *stream) {
+  if (!stream) return;
+
+  // 걸려 있는 읽기는 취소 후 완료를 기다린 뒤 버퍼 반납
+  CancelIoEx(stream->handle, NULL);
+  for (int i = 0; i < STREAM_DEPTH; i++) {
+    stream_block *block = &stream->blocks[i];
+    if (block->pending) {
+      DWORD ignored;
+      GetOverlappedResult(stream->handle, &block->overlapped, &ignored, TRUE);
+    }
+    if (block->overlapped.hEvent) CloseHandle(block->overlapped.hEvent);
+    pool_release(block->buffer);
+  }
+
+  CloseHandle(stream->handle);
+  free(stream);
+}
@@ -0,0 +1,197 @@
+/*
+ * 파일 변경 감시
+ * 1. document_root 디렉토리 핸들을 하위 트리까지 감시
+ * 2. 변경 이벤트를 캐시 경로로 변환해 무효화
+ * 3. 이벤트 버퍼 오버플로 시 캐시 전체 비우기
+ */
+
+#include "file_watcher.h"
+#include "file_handler.h"
+#include <windows.h>
+#include <process.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "error_handle.h"
+#include "logger.h"
+
+#define WATCH_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+  HANDLE dir; // 감시 대상 디렉토리 핸들
+  HANDLE thread; // 감시 스레드
+  HANDLE stop_event; // 종료 신호
+  char root[PATH_MAX]; // document_root
+  volatile LONG active; // 감시 중 여부
+} file_watcher;
+
+static file_watcher watcher = {0};
+
+// 변경 알림 하나를 처리
+static void handle_notification(const FILE_NOTIFY_INFORMATION *info) {
+  char relative[PATH_MAX];
+  int len = WideCharToMultiByte(CP_ACP,
+                                0,
+                                info->FileName,
+                                (int) (info->FileNameLength / sizeof(WCHAR)),
+                                relative,
+                                sizeof(relative) - 1,
+                                NULL,
+                                NULL);
+  if (len <= 0) return;
+  relative[len] = '\0';
+
+  char full_path[PATH_MAX];
+  snprintf(full_path, sizeof(full_path), "%s\\%s", watcher.root, relative);
+
+  switch (info->Action) {
+    case FILE_ACTION_ADDED:
+    case FILE_ACTION_RENAMED_NEW_NAME:
+      // 새로 생긴 경로의 404 부정 캐시 제거
+      cache_invalidate(full_path);
+      break;
+    case FILE_ACTION_REMOVED:
+    case FILE_ACTION_RENAMED_OLD_NAME:
+      // 디렉토리일 수 있으므로 하위 경로까지 제거
+      cache_invalidate(full_path);
+      cache_invalidate_prefix(full_path);
+      break;
+    default:
+      cache_invalidate(full_path);
+      break;
+  }
+}
+
+// 감시 스레드
+static unsigned __stdcall watch_thread(void *arg) {
+  (void) arg;
+
+  // ReadDirectoryChangesW는 DWORD 정렬 버퍼 필요
+  static DWORD buffer[WATCH_BUFFER_SIZE / sizeof(DWORD)];
+  OVERLAPPED overlapped = {0};
+  overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if (!overlapped.hEvent) {
+    InterlockedExchange(&watcher.active, 0);
+    return 1;
+  }
+
+  HANDLE wait_handles[2] = {overlapped.hEvent, watcher.stop_event};
+
+  while (1) {
+    ResetEvent(overlapped.hEvent);
+    BOOL ok = ReadDirectoryChangesW(watcher.dir,
+                                    buffer,
+                                    sizeof(buffer),
+                                    TRUE,
+                                    FILE_NOTIFY_CHANGE_FILE_NAME |
+                                    FILE_NOTIFY_CHANGE_DIR_NAME |
+                                    FILE_NOTIFY_CHANGE_SIZE |
+                                    FILE_NOTIFY_CHANGE_LAST_WRITE,
+                                    NULL,
+                                    &overlapped,
+                                    NULL);
+    if (!ok) {
+      LOG_ERROR("ReadDirectoryChangesW failed", watcher.root);
+      break;
+    }
+
+    DWORD wait = WaitForMultipleObjects(2, wait_handles, FALSE, INFINITE);
+    if (wait != WAIT_OBJECT_0) {
+      // 종료 요청
+      CancelIoEx(watcher.dir, &overlapped);
+      DWORD ignored;
+      GetOverlappedResult(watcher.dir, &overlapped, &ignored, TRUE);
+      break;
+    }
+
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(watcher.dir, &overlapped, &bytes, FALSE)) {
+      if (GetLastError() == ERROR_NOTIFY_ENUM_DIR) {
+        cache_clear();
+        continue;
+      }
+      LOG_ERROR("Directory change notification failed", watcher.root);
+      break;
+    }
+
+    // 버퍼 오버플로: 어떤 파일이 바뀌었는지 알 수 없으므로 전부 무효화
+    if (bytes == 0) {
+      LOG_WARN("Watch buffer overflow, clearing cache");
+      cache_clear();
+      continue;
+    }
+
+    const BYTE *cursor = (const BYTE *) buffer;
+    while (1) {
+      const FILE_NOTIFY_INFORMATION *info = (const FILE_NOTIFY_INFORMATION *) cursor;
+      handle_notification(info);
+      if (info->NextEntryOffset == 0) break;
+      cursor += info->NextEntryOffset;
+    }
+  }
+
+  // 감시가 끊기면 캐시 히트 시 stat 검증으로 복귀
+  InterlockedExchange(&watcher.active, 0);
+  CloseHandle(overlapped.hEvent);
+  return 0;
+}
+
+int file_watcher_start(const char *root_path) {
+  if (watcher.thread) return 0;
+
+  strncpy(watcher.root, root_path, sizeof(watcher.root) - 1);
+
+  watcher.dir = CreateFile(root_path,
+                           FILE_LIST_DIRECTORY,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           NULL,
+                           OPEN_EXISTING,
+                           FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                           NULL);
+  if (watcher.dir == INVALID_HANDLE_VALUE) {
+    LOG_ERROR("Failed to open document root for watching", root_path);
+    watcher.dir = NULL;
+    return -1;
+  }
+
+  watcher.stop_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if (!watcher.stop_event) {
+    CloseHandle(watcher.dir);
+    watcher.dir = NULL;
+    return -1;
+  }
+
+  // 스레드 시작 전에 활성화 (시작 직후 캐시 조회도 감시 대상)
+  InterlockedExchange(&watcher.active, 1);
+  watcher.thread = (HANDLE) _beginthreadex(NULL, 0, watch_thread, NULL, 0, NULL);
+  if (!watcher.thread) {
+    InterlockedExchange(&watcher.active, 0);
+    CloseHandle(watcher.stop_event);
+    CloseHandle(watcher.dir);
+    watcher.stop_event = NULL;
+    watcher.dir = NULL;
+    return -1;
+  }
+
+  printf("Watching %s for changes\n", root_path);
+  return 0;
+}
+
+void file_watcher_stop(void) {
+  if (!watcher.thread) return;
+
+  SetEvent(watcher.stop_event);
+  WaitForSingleObject(watcher.thread, INFINITE);
+
+  CloseHandle(watcher.thread);
+  CloseHandle(watcher.stop_event);
+  CloseHandle(watcher.dir);
+  watcher.thread = NULL;
+  watcher.stop_event = NULL;
+  watcher.dir = NULL;
+  InterlockedExchange(&watcher.active, 0);
+}
+
+int file_watcher_active(void) {
+  return watcher.active != 0;
+}
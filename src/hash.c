@@ -0,0 +1,99 @@
+/*
+ * 64비트 xxHash
+ * 1. 32바이트 블록을 독립된 4개 누산기로 처리 (컴파일러가 벡터화/병렬 실행 가능)
+ * 2. 남은 8/4/1바이트 처리 후 avalanche
+ */
+
+#include "hash.h"
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static unsigned long long rotl64(unsigned long long x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// 정렬되지 않은 주소에서 읽기 (리틀 엔디안 가정)
+static unsigned long long read64(const unsigned char *p) {
+  unsigned long long v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static unsigned int read32(const unsigned char *p) {
+  unsigned int v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static unsigned long long xxh_round(unsigned long long acc, unsigned long long input) {
+  acc += input * PRIME64_2;
+  acc = rotl64(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static unsigned long long xxh_merge(unsigned long long acc, unsigned long long val) {
+  acc ^= xxh_round(0, val);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+unsigned long long hash64(const void *data, size_t length, unsigned long long seed) {
+  const unsigned char *p = (const unsigned char *) data;
+  const unsigned char *end = p + length;
+  unsigned long long h;
+
+  if (length >= 32) {
+    const unsigned char *limit = end - 32;
+    unsigned long long v1 = seed + PRIME64_1 + PRIME64_2;
+    unsigned long long v2 = seed + PRIME64_2;
+    unsigned long long v3 = seed;
+    unsigned long long v4 = seed - PRIME64_1;
+
+    do {
+      v1 = xxh_round(v1, read64(p));
+      v2 = xxh_round(v2, read64(p + 8));
+      v3 = xxh_round(v3, read64(p + 16));
+      v4 = xxh_round(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h = xxh_merge(h, v1);
+    h = xxh_merge(h, v2);
+    h = xxh_merge(h, v3);
+    h = xxh_merge(h, v4);
+  } else {
+    h = seed + PRIME64_5;
+  }
+
+  h += (unsigned long long) length;
+
+  while (p + 8 <= end) {
+    h ^= xxh_round(0, read64(p));
+    h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    p += 8;
+  }
+
+  if (p + 4 <= end) {
+    h ^= (unsigned long long) read32(p) * PRIME64_1;
+    h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+
+  while (p < end) {
+    h ^= (*p) * PRIME64_5;
+    h = rotl64(h, 11) * PRIME64_1;
+    p++;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
@@ -13,6 +13,7 @@
 #include <stdlib.h>
 
 #include "error_handle.h"
+#include "logger.h"
 
 // HTTP 메소드를 문자열로
 const char *get_method_string(http_method method) {
@@ -112,14 +113,14 @@ http_request parse_http_request(const char *raw_request) {
   // 요청 라인 추출
   const char *line_end = strstr(raw_request, "\r\n");
   if (!line_end) {
-    printf("Invalid HTTP request: No CRLF found\n");
+    LOG_WARN("Invalid HTTP request: No CRLF found");
     req.method = HTTP_UNKNOWN;
     return req;
   }
 
   size_t request_line_length = line_end - raw_request;
   if (request_line_length >= sizeof(req.path)) {
-    printf("Request line too long\n");
+    LOG_WARN("Request line too long");
     req.method = HTTP_UNKNOWN;
     return req;
   }
@@ -134,7 +135,7 @@ http_request parse_http_request(const char *raw_request) {
   char *version = strtok(NULL, " ");
 
   if (!method_str || !path || !version) {
-    printf("Failed to parse request line\n");
+    LOG_WARN("Failed to parse request line");
     req.method = HTTP_UNKNOWN;
     return req;
   }
@@ -200,7 +201,7 @@ http_request parse_http_request(const char *raw_request) {
       else if (strcasecmp(header_line, "Content-Type") == 0)
         strncpy(req.content_type, value, sizeof(req.content_type) - 1);
       else if (strcasecmp(header_line, "Content-Length") == 0)
-        req.content_length = atol(value);
+        req.content_length = strtoll(value, NULL, 10);
       else if (strcasecmp(header_line, "Accept") == 0)
         strncpy(req.accept, value, sizeof(req.accept) - 1);
 
@@ -221,8 +222,8 @@ http_request parse_http_request(const char *raw_request) {
   const char *content_type = get_header_value(&req, "Content-Type");
   req.content_type_enum = parse_content_type(content_type);
 
-  // POST/PUT 데이터 파싱
-  if ((req.method == HTTP_POST || req.method == HTTP_PUT) && req.content_length > 0) {
+  // POST 데이터 파싱 (PUT 본문은 연결 처리기에서 파일로 바로 스트리밍)
+  if (req.method == HTTP_POST && req.content_length > 0) {
     const char *body = strstr(raw_request, "\r\n\r\n");
     if (body) {
       body += 4;
@@ -323,35 +324,35 @@ const char *get_post_param(const http_request *request, const char *param_name)
   return NULL;
 }
 
-// HTTP 요청 정보 출력
+// HTTP 요청 정보 출력 (디버그 로그)
 void print_http_request(const http_request *req) {
-  printf("=== HTTP Request ===\n");
-  printf("Method: %s\n", get_method_string(req->method));
-  printf("Path: %s\n", req->path);
-  printf("Base Path: %s\n", req->base_path);
-  printf("Query String: %s\n", req->query_string);
-  printf("Version: %s\n", req->version);
-
-  printf("\n=== Headers (%d) ===\n", req->header_count);
+  LOG_DEBUG("=== HTTP Request ===");
+  LOG_DEBUG("Method: %s", get_method_string(req->method));
+  LOG_DEBUG("Path: %s", req->path);
+  LOG_DEBUG("Base Path: %s", req->base_path);
+  LOG_DEBUG("Query String: %s", req->query_string);
+  LOG_DEBUG("Version: %s", req->version);
+
+  LOG_DEBUG("=== Headers (%d) ===", req->header_count);
   for (int i = 0; i < req->header_count; i++) {
-    printf("%s: %s\n", req->headers[i].name, req->headers[i].value);
+    LOG_DEBUG("%s: %s", req->headers[i].name, req->headers[i].value);
   }
 
   if (req->query_param_count > 0) {
-    printf("\n=== Query Parameters (%d) ===\n", req->query_param_count);
+    LOG_DEBUG("=== Query Parameters (%d) ===", req->query_param_count);
     for (int i = 0; i < req->query_param_count; i++) {
-      printf("%s: %s\n", req->query_params[i].name, req->query_params[i].value);
+      LOG_DEBUG("%s: %s", req->query_params[i].name, req->query_params[i].value);
     }
   }
 
   if (req->post_param_count > 0) {
-    printf("\n=== POST Parameters (%d) ===\n", req->post_param_count);
+    LOG_DEBUG("=== POST Parameters (%d) ===", req->post_param_count);
     for (int i = 0; i < req->post_param_count; i++) {
-      printf("%s: %s\n", req->post_params[i].name, req->post_params[i].value);
+      LOG_DEBUG("%s: %s", req->post_params[i].name, req->post_params[i].value);
     }
   }
 
-  printf("==================\n");
+  LOG_DEBUG("==================");
 }
 
 // Content-Type 파싱
@@ -368,6 +369,147 @@ content_type_t parse_content_type(const char *content_type) {
   return CONTENT_TYPE_UNKNOWN;
 }
 
+// Accept-Encoding 파싱 (q=0은 거부, '*'는 명시되지 않은 인코딩 허용)
+int parse_accept_encoding(const char *accept_encoding) {
+  if (!accept_encoding) return 0;
+
+  int accepted = 0;
+  int rejected = 0;
+  int wildcard = 0;
+  const char *cur = accept_encoding;
+
+  while (*cur) {
+    // 토큰 이름
+    while (*cur == ' ' || *cur == ',') cur++;
+    const char *name = cur;
+    while (*cur && *cur != ',' && *cur != ';' && *cur != ' ') cur++;
+    size_t name_len = cur - name;
+    if (name_len == 0) {
+      while (*cur && *cur != ',') cur++;
+      continue;
+    }
+
+    // q 값 (없으면 1)
+    double q = 1.0;
+    while (*cur && *cur != ',') {
+      if (*cur == ';') {
+        cur++;
+        while (*cur == ' ') cur++;
+        if ((*cur == 'q' || *cur == 'Q') && cur[1] == '=') {
+          q = strtod(cur + 2, NULL);
+        }
+      } else {
+        cur++;
+      }
+    }
+
+    int bit = 0;
+    if (name_len == 4 && strncasecmp(name, "gzip", 4) == 0) bit = ACCEPT_ENCODING_GZIP;
+    else if (name_len == 2 && strncasecmp(name, "br", 2) == 0) bit = ACCEPT_ENCODING_BR;
+    else if (name_len == 1 && name[0] == '*') wildcard = q > 0 ? 1 : -1;
+
+    if (bit) {
+      if (q > 0) accepted |= bit;
+      else rejected |= bit;
+    }
+  }
+
+  if (wildcard > 0) {
+    accepted |= (ACCEPT_ENCODING_GZIP | ACCEPT_ENCODING_BR) & ~rejected;
+  }
+  return accepted & ~rejected;
+}
+
+// 약한 비교를 위해 W/ 접두어 제거
+static const char *strip_weak_prefix(const char *etag) {
+  if (etag[0] == 'W' && etag[1] == '/') return etag + 2;
+  return etag;
+}
+
+// If-None-Match 파싱
+int etag_list_matches(const char *if_none_match, const char *etag) {
+  if (!if_none_match || !etag || !*etag) return 0;
+
+  const char *target = strip_weak_prefix(etag);
+  size_t target_len = strlen(target);
+  const char *cur = if_none_match;
+
+  while (*cur) {
+    while (*cur == ' ' || *cur == '\t' || *cur == ',') cur++;
+    if (!*cur) break;
+
+    if (*cur == '*') return 1;
+
+    // W/"..." 또는 "..." 한 개
+    const char *tag = strip_weak_prefix(cur);
+    if (*tag != '"') {
+      // 형식이 잘못된 항목은 다음 쉼표까지 건너뜀
+      while (*cur && *cur != ',') cur++;
+      continue;
+    }
+    const char *close = strchr(tag + 1, '"');
+    if (!close) break;
+
+    size_t tag_len = close - tag + 1;
+    if (tag_len == target_len && strncmp(tag, target, tag_len) == 0) return 1;
+    cur = close + 1;
+  }
+  return 0;
+}
+
+// 1970-01-01 기준 일수 (그레고리력)
+static long long days_from_civil(int year, int month, int day) {
+  year -= month <= 2;
+  long long era = (year >= 0 ? year : year - 399) / 400;
+  int yoe = year - (int) (era * 400);
+  int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+static int month_from_name(const char *name) {
+  static const char *const MONTHS[] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+  for (int i = 0; i < 12; i++) {
+    if (strncmp(name, MONTHS[i], 3) == 0) return i + 1;
+  }
+  return 0;
+}
+
+// HTTP 날짜 파싱
+time_t parse_http_date(const char *value) {
+  if (!value) return -1;
+
+  int day, year, hour, minute, second;
+  char month_name[4] = {0};
+  char weekday[16];
+
+  // IMF-fixdate: Sun, 06 Nov 1994 08:49:37 GMT
+  if (sscanf(value, "%15[A-Za-z], %d %3s %d %d:%d:%d GMT",
+             weekday, &day, month_name, &year, &hour, &minute, &second) == 7) {
+    // 그대로 사용
+  }
+  // RFC 850: Sunday, 06-Nov-94 08:49:37 GMT
+  else if (sscanf(value, "%15[A-Za-z], %d-%3s-%d %d:%d:%d GMT",
+                  weekday, &day, month_name, &year, &hour, &minute, &second) == 7) {
+    year += year < 70 ? 2000 : (year < 100 ? 1900 : 0);
+  }
+  // asctime: Sun Nov  6 08:49:37 1994
+  else if (sscanf(value, "%15s %3s %d %d:%d:%d %d",
+                  weekday, month_name, &day, &hour, &minute, &second, &year) == 7) {
+    // 그대로 사용
+  } else {
+    return -1;
+  }
+
+  int month = month_from_name(month_name);
+  if (!month || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return -1;
+
+  long long days = days_from_civil(year, month, day);
+  return (time_t) (days * 86400 + hour * 3600 + minute * 60 + second);
+}
+
 // JSON 파싱 (간단한 구현)
 static void skip_whitespace(const char **ptr) {
   while (**ptr && isspace(**ptr)) (*ptr)++;
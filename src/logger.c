@@ -0,0 +1,276 @@
+/*
+ * 비동기 로그
+ * - 링은 스레드가 처음 로그를 남길 때 만들어 목록에 등록 (이후 생산자는 자기 링만 사용)
+ * - 생산자는 head, 출력 스레드는 tail만 갱신 (단일 생산자 / 단일 소비자)
+ * - 스레드 간 순서는 보장하지 않음 (레코드마다 시각, 스레드 ID 포함)
+ * - 스레드가 끝나면 FLS 콜백이 링을 은퇴 표시, 출력 스레드가 남은 레코드를 비운 뒤 해제
+ * - 종료 시 링에 쓰는 중인 생산자가 모두 빠져나간 뒤 링 해제
+ * - logger_init / logger_shutdown은 프로세스당 한 번
+ */
+
+#include "logger.h"
+#include "date_cache.h"
+#include <winsock2.h>
+#include <windows.h>
+#include <process.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+#define LOG_FLUSH_INTERVAL_MS 50 // 링이 반도 안 찼을 때 출력 주기
+#define LOG_BATCH_SIZE (64 * 1024) // 한 번에 쓰는 출력 버퍼
+#define LOG_LINE_MAX (LOG_RECORD_TEXT + LOG_TIME_LEN + 32)
+
+typedef struct {
+  int level;
+  char time[LOG_TIME_LEN + 1];
+  char text[LOG_RECORD_TEXT];
+} log_record;
+
+typedef struct log_ring {
+  volatile LONG head; // 다음에 쓸 위치 (생산자)
+  volatile LONG tail; // 다음에 읽을 위치 (출력 스레드)
+  volatile LONG dropped; // 가득 차서 버린 레코드 수
+  volatile LONG retired; // 소유 스레드 종료 (더 이상 쓰지 않음)
+  DWORD thread_id;
+  struct log_ring *next;
+  log_record records[LOG_RING_SIZE];
+} log_ring;
+
+static struct {
+  volatile LONG running; // 출력 스레드 동작 중 (0이면 바로 출력)
+  volatile LONG stopping;
+  volatile LONG writers; // 링 경로로 들어온 생산자 수 (종료 시 0이 될 때까지 대기)
+  DWORD fls; // 스레드 종료 알림용 FLS 인덱스
+  SRWLOCK lock; // 링 목록 보호
+  log_ring *rings;
+  HANDLE wake; // 링이 반 이상 찼을 때 출력 스레드 깨우기
+  HANDLE thread;
+  char batch[LOG_BATCH_SIZE];
+  size_t batch_length;
+} logger = {.fls = FLS_OUT_OF_INDEXES, .lock = SRWLOCK_INIT};
+
+static THREAD_LOCAL log_ring *thread_ring;
+
+static const char *level_name(int level) {
+  switch (level) {
+    case LOG_LEVEL_DEBUG: return "DEBUG";
+    case LOG_LEVEL_INFO: return "INFO";
+    case LOG_LEVEL_WARN: return "WARN";
+    default: return "LOG";
+  }
+}
+
+// 한 줄 포맷 "[시각] LEVEL [tid] 메시지\n"
+static int format_line(char *out, size_t out_size, const char *time, int level, DWORD thread_id, const char *text) {
+  int length = snprintf(out, out_size, "[%s] %-5s [%lu] %s\n", time, level_name(level), (unsigned long) thread_id, text);
+  if (length < 0) return 0;
+  return length < (int) out_size ? length : (int) out_size - 1;
+}
+
+// 메시지 앞뒤 줄바꿈 제거 (레코드는 한 줄)
+static void format_text(char *out, size_t out_size, const char *format, va_list args) {
+  int length = vsnprintf(out, out_size, format, args);
+  if (length < 0) {
+    out[0] = '\0';
+    return;
+  }
+  if ((size_t) length >= out_size) length = (int) out_size - 1;
+  while (length > 0 && (out[length - 1] == '\n' || out[length - 1] == '\r')) out[--length] = '\0';
+  size_t skip = strspn(out, "\r\n");
+  if (skip > 0) memmove(out, out + skip, (size_t) length - skip + 1);
+}
+
+// 스레드 종료 시 호출 (링 해제는 남은 레코드를 출력한 뒤 출력 스레드가 담당)
+static VOID NTAPI retire_thread_ring(PVOID data) {
+  if (!data) return;
+  // 종료 중인 스레드가 이후에 또 로그를 남겨도 해제될 링에는 쓰지 않도록
+  if (thread_ring == data) thread_ring = NULL;
+  InterlockedExchange(&((log_ring *) data)->retired, 1);
+}
+
+static log_ring *get_thread_ring(void) {
+  if (thread_ring) return thread_ring;
+
+  log_ring *ring = calloc(1, sizeof(log_ring));
+  if (!ring) return NULL;
+  ring->thread_id = GetCurrentThreadId();
+
+  AcquireSRWLockExclusive(&logger.lock);
+  ring->next = logger.rings;
+  logger.rings = ring;
+  ReleaseSRWLockExclusive(&logger.lock);
+
+  FlsSetValue(logger.fls, ring);
+  thread_ring = ring;
+  return ring;
+}
+
+static void batch_flush(void) {
+  if (logger.batch_length == 0) return;
+  fwrite(logger.batch, 1, logger.batch_length, stdout);
+  fflush(stdout);
+  logger.batch_length = 0;
+}
+
+static void batch_append(const char *line, int length) {
+  if (logger.batch_length + (size_t) length > sizeof(logger.batch)) batch_flush();
+  memcpy(logger.batch + logger.batch_length, line, (size_t) length);
+  logger.batch_length += (size_t) length;
+}
+
+// 모든 링의 레코드를 배치 버퍼로 옮기고 한 번에 출력, 은퇴한 링은 비운 뒤 해제
+static void drain_rings(void) {
+  char line[LOG_LINE_MAX];
+
+  AcquireSRWLockExclusive(&logger.lock);
+  log_ring **link = &logger.rings;
+  while (*link) {
+    log_ring *ring = *link;
+    // 은퇴 표시를 먼저 읽어야 그 전에 공개된 레코드까지 모두 보임
+    LONG retired = InterlockedCompareExchange(&ring->retired, 0, 0);
+    ULONG tail = (ULONG) ring->tail;
+    ULONG head = (ULONG) InterlockedCompareExchange(&ring->head, 0, 0);
+
+    while (tail != head) {
+      const log_record *record = &ring->records[tail & (LOG_RING_SIZE - 1)];
+      batch_append(line, format_line(line, sizeof(line), record->time, record->level, ring->thread_id, record->text));
+      tail++;
+    }
+    InterlockedExchange(&ring->tail, (LONG) tail);
+
+    LONG dropped = InterlockedExchange(&ring->dropped, 0);
+    if (dropped > 0) {
+      char text[64];
+      snprintf(text, sizeof(text), "%ld log records dropped (ring full)", (long) dropped);
+      batch_append(line, format_line(line, sizeof(line), log_time_now(), LOG_LEVEL_WARN, ring->thread_id, text));
+    }
+
+    if (retired) {
+      *link = ring->next;
+      free(ring);
+    } else {
+      link = &ring->next;
+    }
+  }
+  ReleaseSRWLockExclusive(&logger.lock);
+
+  batch_flush();
+}
+
+static unsigned __stdcall log_drain_thread(void *arg) {
+  (void) arg;
+
+  while (1) {
+    WaitForSingleObject(logger.wake, LOG_FLUSH_INTERVAL_MS);
+    int stopping = logger.stopping;
+    drain_rings(); // 종료 신호 이후에도 남은 레코드를 한 번 더 출력
+    if (stopping) break;
+  }
+
+  return 0;
+}
+
+int logger_init(void) {
+  logger.fls = FlsAlloc(retire_thread_ring);
+  if (logger.fls == FLS_OUT_OF_INDEXES) return -1;
+
+  logger.wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+  if (!logger.wake) {
+    FlsFree(logger.fls);
+    logger.fls = FLS_OUT_OF_INDEXES;
+    return -1;
+  }
+
+  logger.thread = (HANDLE) _beginthreadex(NULL, 0, log_drain_thread, NULL, 0, NULL);
+  if (!logger.thread) {
+    CloseHandle(logger.wake);
+    logger.wake = NULL;
+    FlsFree(logger.fls);
+    logger.fls = FLS_OUT_OF_INDEXES;
+    return -1;
+  }
+
+  InterlockedExchange(&logger.running, 1);
+  return 0;
+}
+
+void logger_shutdown(void) {
+  if (!logger.running) return;
+
+  // 이후 기록은 바로 출력, 이미 링에 쓰고 있는 생산자가 끝날 때까지 대기
+  InterlockedExchange(&logger.running, 0);
+  while (InterlockedCompareExchange(&logger.writers, 0, 0) != 0) SwitchToThread();
+
+  // 출력 스레드는 남은 레코드를 비우고 종료
+  InterlockedExchange(&logger.stopping, 1);
+  SetEvent(logger.wake);
+  WaitForSingleObject(logger.thread, INFINITE);
+  CloseHandle(logger.thread);
+  CloseHandle(logger.wake);
+  logger.thread = NULL;
+  logger.wake = NULL;
+
+  // 인덱스를 먼저 해제해야 이후 스레드 종료 콜백이 해제된 링을 건드리지 않음
+  FlsFree(logger.fls);
+  logger.fls = FLS_OUT_OF_INDEXES;
+
+  AcquireSRWLockExclusive(&logger.lock);
+  log_ring *ring = logger.rings;
+  logger.rings = NULL;
+  ReleaseSRWLockExclusive(&logger.lock);
+
+  while (ring) {
+    log_ring *next = ring->next;
+    free(ring);
+    ring = next;
+  }
+  thread_ring = NULL;
+}
+
+void log_write(int level, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+
+  // 종료가 링 해제 전에 기다릴 수 있도록 running 확인 전에 생산자 등록
+  InterlockedIncrement(&logger.writers);
+  log_ring *ring = logger.running ? get_thread_ring() : NULL;
+  if (!ring) {
+    InterlockedDecrement(&logger.writers);
+    char text[LOG_RECORD_TEXT];
+    char line[LOG_LINE_MAX];
+    format_text(text, sizeof(text), format, args);
+    va_end(args);
+    fwrite(line, 1, (size_t) format_line(line, sizeof(line), log_time_now(), level, GetCurrentThreadId(), text), stdout);
+    return;
+  }
+
+  ULONG head = (ULONG) ring->head;
+  ULONG used = head - (ULONG) ring->tail;
+  if (used >= LOG_RING_SIZE) {
+    va_end(args);
+    InterlockedIncrement(&ring->dropped);
+    SetEvent(logger.wake);
+    InterlockedDecrement(&logger.writers);
+    return;
+  }
+
+  log_record *record = &ring->records[head & (LOG_RING_SIZE - 1)];
+  record->level = level;
+  memcpy(record->time, log_time_now(), LOG_TIME_LEN + 1);
+  format_text(record->text, sizeof(record->text), format, args);
+  va_end(args);
+
+  // 레코드를 다 채운 뒤 공개
+  InterlockedExchange(&ring->head, (LONG) (head + 1));
+
+  if (used + 1 == LOG_RING_SIZE / 2) SetEvent(logger.wake);
+  InterlockedDecrement(&logger.writers);
+}
@@ -7,6 +7,16 @@
 #include "server.h"
 #include "config.h"
 #include "file_handler.h"
+#include "file_watcher.h"
+#include "open_file_cache.h"
+#include "mime_types.h"
+#include "bundle.h"
+#include "blob_store.h"
+#include "file_stream.h"
+#include "slice_cache.h"
+#include "cache_warmup.h"
+#include "logger.h"
+#include "error_handle.h"
 #include <stdio.h>
 
 int main() {
@@ -25,6 +35,52 @@ int main() {
   // 설정 출력
   print_config(&config);
 
+  // 에러 로그 파일 (실패 시 stderr에만 출력)
+  if (error_log_open(config.error_log_file, config.error_log_max_size, config.error_log_rotate_interval) != 0) {
+    fprintf(stderr, "Failed to open error log: %s\n", config.error_log_file);
+  }
+
+  // 비동기 로그 출력 스레드 (실패 시 호출 스레드에서 바로 출력)
+  if (logger_init() != 0) {
+    fprintf(stderr, "Logger thread unavailable, logging synchronously\n");
+  }
+
+  // document_root 열기 (요청 경로는 이 디렉토리 기준으로 검증)
+  if (docroot_init(config.document_root) != 0) {
+    fprintf(stderr, "Failed to open document root: %s\n", config.document_root);
+    return 1;
+  }
+
+  // MIME 테이블 생성 (파일이 없으면 기본 매핑만 사용)
+  if (mime_types_init(config.mime_types_file) != 0) {
+    fprintf(stderr, "Failed to build MIME type table\n");
+    return 1;
+  }
+
+  // 정적 파일 번들 매핑 (없거나 잘못된 번들이면 디스크에서 제공)
+  if (bundle_open(config.bundle_file) < 0) {
+    fprintf(stderr, "Warning: ignoring invalid bundle: %s\n", config.bundle_file);
+  }
+
+  // 큰 파일 구간 캐시 (실패 시 Range 요청도 스트리밍)
+  if (slice_cache_init(config.slice_cache_size) != 0) {
+    fprintf(stderr, "Slice cache unavailable, streaming ranges from disk\n");
+  }
+
+  // 업로드 중복 제거 저장소 (uploads 아래 숨김 폴더, 실패 시 이름별로 그대로 저장)
+  if (config.upload_dedup) {
+    char blob_dir[1024];
+    snprintf(blob_dir, sizeof(blob_dir), "%s\\uploads\\.blobs", config.document_root);
+    if (blob_store_init(blob_dir) != 0) {
+      fprintf(stderr, "Blob store unavailable, storing uploads by name\n");
+    }
+  }
+
+  // 열린 파일 캐시 초기화
+  open_file_cache_init(config.open_file_cache_max,
+                       config.open_file_cache_valid,
+                       config.negative_cache_ttl);
+
   // 서버 초기화
   http_server server = {0};
   server.config = config;
@@ -34,14 +90,39 @@ int main() {
     return 1;
   }
 
+  // 파일 변경 감시 시작 (실패 시 캐시 히트마다 stat으로 검증)
+  if (file_watcher_start(server.config.document_root) != 0) {
+    fprintf(stderr, "File watcher unavailable, falling back to stat validation\n");
+  }
+
+  // 캐시 예열 (BLOCKING 모드는 끝난 뒤에 요청 수신 시작)
+  if (cache_warmup_start(&server.config) != 0) {
+    fprintf(stderr, "Cache warm-up failed to start, serving cold\n");
+  }
+
   // 서버 시작
   int result = server_start(&server);
 
   // 서버 종료
   server_stop(&server);
+  cache_warmup_stop();
+  file_watcher_stop();
+  logger_shutdown(); // 남은 로그를 먼저 출력
+  server_print_stats();
+  cache_print_stats();
+  slice_cache_print_stats();
+  blob_store_print_stats();
 
   // 캐시 정리
+  open_file_cache_cleanup();
   cache_cleanup();
+  docroot_cleanup();
+  bundle_close();
+  blob_store_cleanup();
+  mime_types_cleanup();
+  file_stream_pool_cleanup();
+  slice_cache_cleanup();
+  error_log_close();
 
   return result;
 }
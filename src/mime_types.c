@@ -0,0 +1,220 @@
+/*
+ * 확장자 -> Content-Type 해시 테이블
+ * - 개방 주소법, 부하율 0.5 이하 (대부분 한 번의 비교로 끝남)
+ * - 같은 타입은 인턴된 문자열 하나를 공유
+ */
+
+#include "mime_types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MIME_EXT_MAX 16 // 확장자 최대 길이 (점 제외, NUL 포함)
+#define DEFAULT_MIME_TYPE "application/octet-stream"
+
+typedef struct {
+  const char *extension; // 점 제외
+  const char *mime_type;
+} mime_mapping;
+
+// 기본 매핑 (mime.types 파일의 같은 확장자가 덮어씀)
+static const mime_mapping DEFAULT_MIME_TYPES[] = {
+  {"html", "text/html"},
+  {"htm", "text/html"},
+  {"css", "text/css"},
+  {"js", "application/javascript"},
+  {"json", "application/json"},
+  {"txt", "text/plain"},
+  {"jpg", "image/jpeg"},
+  {"jpeg", "image/jpeg"},
+  {"png", "image/png"},
+  {"gif", "image/gif"},
+  {"svg", "image/svg+xml"},
+  {"ico", "image/x-icon"},
+  {"pdf", "application/pdf"},
+  {"xml", "application/xml"},
+  {"zip", "application/zip"},
+};
+
+typedef struct {
+  char extension[MIME_EXT_MAX]; // 소문자, 빈 문자열이면 빈 슬롯
+  const char *content_type; // 인턴된 Content-Type
+} mime_slot;
+
+static mime_slot *table = NULL;
+static size_t table_mask = 0;
+static size_t table_count = 0;
+
+// 인턴된 Content-Type 문자열
+static char **interned = NULL;
+static size_t interned_count = 0;
+static size_t interned_capacity = 0;
+
+// 확장자 해시 (FNV-1a)
+static unsigned int hash_extension(const char *ext) {
+  unsigned int hash = 2166136261u;
+  while (*ext) {
+    hash ^= (unsigned char) *ext++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// 텍스트 기반 타입은 UTF-8 charset 포함
+static int needs_charset(const char *mime_type) {
+  return strncmp(mime_type, "text/", 5) == 0 ||
+         strcmp(mime_type, "application/json") == 0 ||
+         strcmp(mime_type, "application/javascript") == 0;
+}
+
+// 완성된 Content-Type 문자열을 한 번만 만들어 반환
+static const char *intern_content_type(const char *mime_type) {
+  char formatted[256];
+  snprintf(formatted, sizeof(formatted), needs_charset(mime_type) ? "%s; charset=utf-8" : "%s", mime_type);
+
+  for (size_t i = 0; i < interned_count; i++) {
+    if (strcmp(interned[i], formatted) == 0) return interned[i];
+  }
+
+  if (interned_count == interned_capacity) {
+    size_t capacity = interned_capacity ? interned_capacity * 2 : 32;
+    char **grown = (char **) realloc(interned, capacity * sizeof(char *));
+    if (!grown) return NULL;
+    interned = grown;
+    interned_capacity = capacity;
+  }
+
+  char *copy = strdup(formatted);
+  if (!copy) return NULL;
+  interned[interned_count++] = copy;
+  return copy;
+}
+
+// 확장자를 소문자로 복사 (너무 길면 0)
+static int normalize_extension(const char *ext, char *out) {
+  size_t len = 0;
+  for (; ext[len]; len++) {
+    if (len + 1 >= MIME_EXT_MAX) return 0;
+    out[len] = (char) tolower((unsigned char) ext[len]);
+  }
+  out[len] = '\0';
+  return len > 0;
+}
+
+static mime_slot *find_slot(const char *ext) {
+  size_t index = hash_extension(ext) & table_mask;
+  while (table[index].extension[0] && strcmp(table[index].extension, ext) != 0) {
+    index = (index + 1) & table_mask;
+  }
+  return &table[index];
+}
+
+// 테이블 크기 확보 (부하율 0.5 이하 유지)
+static int ensure_capacity(size_t count) {
+  size_t size = table_mask + 1;
+  if (table && count * 2 <= size) return 0;
+
+  size_t new_size = table ? size * 2 : 64;
+  while (count * 2 > new_size) new_size <<= 1;
+
+  mime_slot *old_table = table;
+  size_t old_size = table ? size : 0;
+
+  table = (mime_slot *) calloc(new_size, sizeof(mime_slot));
+  if (!table) {
+    table = old_table;
+    return -1;
+  }
+  table_mask = new_size - 1;
+
+  for (size_t i = 0; i < old_size; i++) {
+    if (old_table[i].extension[0]) {
+      *find_slot(old_table[i].extension) = old_table[i];
+    }
+  }
+  free(old_table);
+  return 0;
+}
+
+// 매핑 추가 (같은 확장자는 덮어씀)
+static int add_mapping(const char *extension, const char *mime_type) {
+  char ext[MIME_EXT_MAX];
+  if (!normalize_extension(extension, ext)) return -1;
+  if (ensure_capacity(table_count + 1) != 0) return -1;
+
+  const char *content_type = intern_content_type(mime_type);
+  if (!content_type) return -1;
+
+  mime_slot *slot = find_slot(ext);
+  if (!slot->extension[0]) {
+    memcpy(slot->extension, ext, sizeof(ext));
+    table_count++;
+  }
+  slot->content_type = content_type;
+  return 0;
+}
+
+// mime.types 형식: "타입 확장자1 확장자2 ..." ('#' 이후는 주석)
+static void load_mime_types_file(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) return;
+
+  char line[1024];
+  int loaded = 0;
+  while (fgets(line, sizeof(line), file)) {
+    char *comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+
+    char *mime_type = strtok(line, " \t\r\n");
+    if (!mime_type || !strchr(mime_type, '/')) continue;
+
+    char *ext;
+    while ((ext = strtok(NULL, " \t\r\n")) != NULL) {
+      if (add_mapping(ext, mime_type) == 0) loaded++;
+    }
+  }
+
+  fclose(file);
+  printf("Loaded %d MIME mappings from %s\n", loaded, path);
+}
+
+int mime_types_init(const char *mime_types_file) {
+  for (size_t i = 0; i < sizeof(DEFAULT_MIME_TYPES) / sizeof(DEFAULT_MIME_TYPES[0]); i++) {
+    if (add_mapping(DEFAULT_MIME_TYPES[i].extension, DEFAULT_MIME_TYPES[i].mime_type) != 0) {
+      mime_types_cleanup();
+      return -1;
+    }
+  }
+
+  if (mime_types_file && mime_types_file[0]) {
+    load_mime_types_file(mime_types_file);
+  }
+  return 0;
+}
+
+void mime_types_cleanup(void) {
+  for (size_t i = 0; i < interned_count; i++) {
+    free(interned[i]);
+  }
+  free(interned);
+  free(table);
+  interned = NULL;
+  interned_count = interned_capacity = 0;
+  table = NULL;
+  table_mask = table_count = 0;
+}
+
+const char *get_mime_type(const char *file_path) {
+  if (!file_path || !table) return DEFAULT_MIME_TYPE;
+
+  // 마지막 경로 구분자 뒤의 확장자
+  const char *dot = strrchr(file_path, '.');
+  if (!dot || strchr(dot, '\\') || strchr(dot, '/')) return DEFAULT_MIME_TYPE;
+
+  char ext[MIME_EXT_MAX];
+  if (!normalize_extension(dot + 1, ext)) return DEFAULT_MIME_TYPE;
+
+  const mime_slot *slot = find_slot(ext);
+  return slot->extension[0] ? slot->content_type : DEFAULT_MIME_TYPE;
+}
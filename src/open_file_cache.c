@@ -0,0 +1,439 @@
+/*
+ * 열린 파일 핸들 및 메타데이터 캐시
+ * 1. 요청 경로 해시 테이블 + LRU 리스트
+ * 2. 미스일 때만 경로 검증, CreateFile, 메타데이터 조회
+ * 3. 유효 시간이 지나면 다시 열어서 검증
+ * 4. 404/거부 결과는 부정 캐시 TTL 동안 경로 검증 없이 응답
+ */
+
+#include "open_file_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "error_handle.h"
+#include "logger.h"
+
+typedef struct {
+  SRWLOCK lock; // 캐시 락
+  open_file **buckets; // 해시 버킷
+  size_t bucket_count; // 버킷 수 (2의 거듭제곱)
+  open_file *lru_head; // 가장 최근 사용
+  open_file *lru_tail; // 가장 오래 전 사용 (제거 대상)
+  size_t size; // 현재 엔트리 수
+  size_t capacity; // 최대 엔트리 수
+  int valid_seconds; // 재검증 주기
+  int negative_ttl; // 에러 결과 TTL (0이면 캐시 안 함)
+} open_file_table;
+
+static open_file_table *table = NULL;
+
+// 1601-01-01 기준 FILETIME과 유닉스 시간 차이 (100ns 단위)
+#define FILETIME_UNIX_EPOCH 116444736000000000ULL
+
+static time_t filetime_to_time(const FILETIME *ft) {
+  unsigned long long ticks = ((unsigned long long) ft->dwHighDateTime << 32) | ft->dwLowDateTime;
+  return (time_t) ((ticks - FILETIME_UNIX_EPOCH) / 10000000ULL);
+}
+
+// 키 해시 (FNV-1a, 파일 시스템처럼 대소문자 구분 없이)
+static unsigned int hash_key(const char *key) {
+  unsigned int hash = 2166136261u;
+  while (*key) {
+    hash ^= (unsigned char) tolower((unsigned char) *key++);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static void free_open_file(open_file *file) {
+  if (file->handle != INVALID_HANDLE_VALUE) {
+    CloseHandle(file->handle);
+  }
+  for (int i = ENCODING_IDENTITY + 1; i < ENCODING_COUNT; i++) {
+    if (file->variants[i].handle != INVALID_HANDLE_VALUE) {
+      CloseHandle(file->variants[i].handle);
+    }
+  }
+  free(file);
+}
+
+void open_file_release(open_file *file) {
+  if (!file) return;
+  if (InterlockedDecrement(&file->ref_count) == 0) {
+    free_open_file(file);
+  }
+}
+
+static void lru_unlink(open_file *file) {
+  if (file->lru_prev) file->lru_prev->lru_next = file->lru_next;
+  else table->lru_head = file->lru_next;
+  if (file->lru_next) file->lru_next->lru_prev = file->lru_prev;
+  else table->lru_tail = file->lru_prev;
+  file->lru_prev = NULL;
+  file->lru_next = NULL;
+}
+
+static void lru_push_front(open_file *file) {
+  file->lru_prev = NULL;
+  file->lru_next = table->lru_head;
+  if (table->lru_head) table->lru_head->lru_prev = file;
+  table->lru_head = file;
+  if (!table->lru_tail) table->lru_tail = file;
+}
+
+// 테이블에서 분리 (락 보유 상태), 캐시 보유 참조는 호출자가 반납
+static int table_unlink(open_file *file) {
+  open_file **link = &table->buckets[file->hash & (table->bucket_count - 1)];
+  while (*link) {
+    if (*link == file) {
+      *link = file->hash_next;
+      file->hash_next = NULL;
+      lru_unlink(file);
+      table->size--;
+      return 1;
+    }
+    link = &(*link)->hash_next;
+  }
+  return 0;
+}
+
+static open_file *table_find(const char *request_path, unsigned int hash) {
+  open_file *file = table->buckets[hash & (table->bucket_count - 1)];
+  while (file) {
+    if (file->hash == hash && _stricmp(file->request_path, request_path) == 0) {
+      return file;
+    }
+    file = file->hash_next;
+  }
+  return NULL;
+}
+
+void open_file_cache_init(size_t max_entries, int valid_seconds, int negative_ttl) {
+  table = (open_file_table *) calloc(1, sizeof(open_file_table));
+  if (!table) return;
+
+  if (max_entries == 0) max_entries = 1;
+  size_t bucket_count = 1;
+  while (bucket_count < max_entries * 2) bucket_count <<= 1;
+
+  InitializeSRWLock(&table->lock);
+  table->buckets = (open_file **) calloc(bucket_count, sizeof(open_file *));
+  table->bucket_count = bucket_count;
+  table->capacity = max_entries;
+  table->valid_seconds = valid_seconds;
+  table->negative_ttl = negative_ttl;
+}
+
+void open_file_cache_cleanup(void) {
+  if (!table) return;
+
+  open_file_cache_clear();
+  free(table->buckets);
+  free(table);
+  table = NULL;
+}
+
+// 사이드카 파일 존재 확인 후 열어 두기 (결과는 엔트리와 함께 캐시)
+static void probe_variants(open_file *file) {
+  for (int i = ENCODING_IDENTITY + 1; i < ENCODING_COUNT; i++) {
+    char variant_path[PATH_MAX];
+    int written = snprintf(variant_path, sizeof(variant_path), "%s%s",
+                           file->path, encoding_suffix((content_encoding) i));
+    if (written < 0 || (size_t) written >= sizeof(variant_path)) continue;
+
+    HANDLE handle = CreateFile(variant_path,
+                               GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               NULL,
+                               OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL,
+                               NULL);
+    if (handle == INVALID_HANDLE_VALUE) continue;
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!docroot_contains(handle) ||
+        !GetFileInformationByHandle(handle, &info) ||
+        (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      CloseHandle(handle);
+      continue;
+    }
+
+    file->variants[i].handle = handle;
+    file->variants[i].size = ((unsigned long long) info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    file->has_variants = 1;
+  }
+}
+
+// 파일을 열고 메타데이터 채우기 (캐시 미스 경로)
+static void open_and_stat(open_file *file, const char *base_path, const char *request_path) {
+  file->status_code = resolve_request_path(base_path, request_path, file->path, sizeof(file->path));
+  if (file->status_code != 200) return;
+
+  file->handle = CreateFile(file->path,
+                            GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            NULL);
+  if (file->handle == INVALID_HANDLE_VALUE) {
+    DWORD error = GetLastError();
+    LOG_WARN("Failed to open file: %s (error: %lu)", file->path, error);
+    if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) {
+      file->status_code = 404;
+    } else if (error == ERROR_ACCESS_DENIED) {
+      file->status_code = 403;
+    } else {
+      file->status_code = 500;
+    }
+    return;
+  }
+
+  // 링크/정션을 따라간 결과가 document_root 밖이면 거부
+  if (!docroot_contains(file->handle)) {
+    CloseHandle(file->handle);
+    file->handle = INVALID_HANDLE_VALUE;
+    file->status_code = 403;
+    return;
+  }
+
+  BY_HANDLE_FILE_INFORMATION info;
+  if (!GetFileInformationByHandle(file->handle, &info)) {
+    CloseHandle(file->handle);
+    file->handle = INVALID_HANDLE_VALUE;
+    file->status_code = 500;
+    return;
+  }
+
+  // 디렉토리는 제공하지 않음
+  if (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+    CloseHandle(file->handle);
+    file->handle = INVALID_HANDLE_VALUE;
+    file->status_code = 403;
+    return;
+  }
+
+  file->size = ((unsigned long long) info.nFileSizeHigh << 32) | info.nFileSizeLow;
+  file->mtime = filetime_to_time(&info.ftLastWriteTime);
+  file->mtime_ticks = ((unsigned long long) info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+  file->file_id = ((unsigned long long) info.dwVolumeSerialNumber << 48) ^
+                  (((unsigned long long) info.nFileIndexHigh << 32) | info.nFileIndexLow);
+
+  struct tm *gmt = gmtime(&file->mtime);
+  if (gmt) {
+    strftime(file->http_date, sizeof(file->http_date), "%a, %d %b %Y %H:%M:%S GMT", gmt);
+  }
+
+  probe_variants(file);
+
+  file->status_code = 200;
+}
+
+open_file *open_file_cache_get(const char *base_path, const char *request_path, int *cache_hit) {
+  unsigned int hash = hash_key(request_path);
+  time_t now = time(NULL);
+
+  if (cache_hit) *cache_hit = 0;
+
+  if (table) {
+    open_file *stale = NULL;
+
+    AcquireSRWLockExclusive(&table->lock);
+    open_file *file = table_find(request_path, hash);
+    if (file) {
+      int ttl = file->status_code == 200 ? table->valid_seconds : table->negative_ttl;
+      if (now - file->validated <= ttl) {
+        InterlockedIncrement(&file->ref_count);
+        lru_unlink(file);
+        lru_push_front(file);
+        ReleaseSRWLockExclusive(&table->lock);
+        if (cache_hit) *cache_hit = 1;
+        return file;
+      }
+      // 유효 시간 경과, 다시 열기
+      table_unlink(file);
+      stale = file;
+    }
+    ReleaseSRWLockExclusive(&table->lock);
+
+    if (stale) open_file_release(stale);
+  }
+
+  open_file *file = (open_file *) calloc(1, sizeof(open_file));
+  if (!file) return NULL;
+
+  // 키가 잘리면 접두사가 같은 다른 경로와 엔트리를 공유하므로 넘치는 경로는 캐시하지 않음
+  size_t key_length = strlen(request_path);
+  int cacheable = key_length < sizeof(file->request_path);
+  if (cacheable) memcpy(file->request_path, request_path, key_length + 1);
+  file->handle = INVALID_HANDLE_VALUE;
+  for (int i = 0; i < ENCODING_COUNT; i++) {
+    file->variants[i].handle = INVALID_HANDLE_VALUE;
+  }
+  file->hash = hash;
+  file->validated = now;
+  file->ref_count = 1; // 호출자 참조
+
+  open_and_stat(file, base_path, request_path);
+
+  // 서버 에러는 캐시하지 않음
+  if (!table || !cacheable || file->status_code == 500 || (file->status_code != 200 && table->negative_ttl == 0)) {
+    return file;
+  }
+
+  open_file *replaced = NULL;
+  open_file *evicted = NULL;
+
+  AcquireSRWLockExclusive(&table->lock);
+
+  // 동시에 같은 경로를 연 경우 나중 것으로 교체
+  replaced = table_find(request_path, hash);
+  if (replaced) table_unlink(replaced);
+
+  if (table->size >= table->capacity && table->lru_tail) {
+    evicted = table->lru_tail;
+    table_unlink(evicted);
+  }
+
+  size_t idx = hash & (table->bucket_count - 1);
+  file->hash_next = table->buckets[idx];
+  table->buckets[idx] = file;
+  lru_push_front(file);
+  table->size++;
+  InterlockedIncrement(&file->ref_count); // 캐시 보유분
+
+  ReleaseSRWLockExclusive(&table->lock);
+
+  if (replaced) open_file_release(replaced);
+  if (evicted) open_file_release(evicted);
+
+  return file;
+}
+
+// full_path가 엔트리의 사이드카 경로인지 (file.ext + .gz/.br)
+static int is_variant_path(const open_file *file, const char *full_path) {
+  size_t len = strlen(file->path);
+  if (len == 0 || _strnicmp(file->path, full_path, len) != 0) return 0;
+
+  for (int i = ENCODING_IDENTITY + 1; i < ENCODING_COUNT; i++) {
+    if (_stricmp(full_path + len, encoding_suffix((content_encoding) i)) == 0) return 1;
+  }
+  return 0;
+}
+
+void open_file_cache_invalidate(const char *full_path) {
+  if (!table) return;
+
+  open_file *removed = NULL;
+
+  // 키가 요청 경로라서 전체 경로로는 순회 필요 (변경 이벤트에서만 호출)
+  AcquireSRWLockExclusive(&table->lock);
+  open_file *file = table->lru_head;
+  while (file) {
+    open_file *next = file->lru_next;
+    // 사이드카가 생기거나 바뀌어도 원본 엔트리를 다시 열어 재검사
+    // 변경 알림은 디스크의 대소문자, 엔트리는 요청의 대소문자이므로 구분 없이 비교
+    if (_stricmp(file->path, full_path) == 0 || is_variant_path(file, full_path)) {
+      table_unlink(file);
+      file->hash_next = removed;
+      removed = file;
+    }
+    file = next;
+  }
+  ReleaseSRWLockExclusive(&table->lock);
+
+  while (removed) {
+    open_file *next = removed->hash_next;
+    open_file_release(removed);
+    removed = next;
+  }
+}
+
+void open_file_cache_invalidate_request(const char *request_path) {
+  if (!table) return;
+
+  unsigned int hash = hash_key(request_path);
+
+  AcquireSRWLockExclusive(&table->lock);
+  open_file *file = table_find(request_path, hash);
+  if (file) table_unlink(file);
+  ReleaseSRWLockExclusive(&table->lock);
+
+  if (file) open_file_release(file);
+}
+
+void open_file_cache_clear(void) {
+  if (!table) return;
+
+  AcquireSRWLockExclusive(&table->lock);
+  open_file *removed = table->lru_head;
+  memset(table->buckets, 0, table->bucket_count * sizeof(open_file *));
+  table->lru_head = NULL;
+  table->lru_tail = NULL;
+  table->size = 0;
+  ReleaseSRWLockExclusive(&table->lock);
+
+  while (removed) {
+    open_file *next = removed->lru_next;
+    removed->hash_next = NULL;
+    removed->lru_prev = NULL;
+    removed->lru_next = NULL;
+    open_file_release(removed);
+    removed = next;
+  }
+}
+
+int open_file_has_variant(const open_file *file, content_encoding encoding) {
+  if (encoding == ENCODING_IDENTITY) return 1;
+  return file->variants[encoding].handle != INVALID_HANDLE_VALUE;
+}
+
+unsigned long long open_file_size(const open_file *file, content_encoding encoding) {
+  return encoding == ENCODING_IDENTITY ? file->size : file->variants[encoding].size;
+}
+
+size_t open_file_read(const open_file *file,
+                      content_encoding encoding,
+                      void *buffer,
+                      size_t length,
+                      unsigned long long offset) {
+  HANDLE handle = encoding == ENCODING_IDENTITY ? file->handle : file->variants[encoding].handle;
+  size_t total = 0;
+
+  while (total < length) {
+    DWORD to_read = (DWORD) min(length - total, (size_t) 1 << 30);
+    OVERLAPPED overlapped = {0};
+    overlapped.Offset = (DWORD) (offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD) (offset >> 32);
+
+    DWORD bytes_read = 0;
+    if (!ReadFile(handle, (char *) buffer + total, to_read, &bytes_read, &overlapped) ||
+        bytes_read == 0) {
+      break;
+    }
+    total += bytes_read;
+    offset += bytes_read;
+  }
+
+  return total;
+}
+
+void *open_file_map(const open_file *file, content_encoding encoding, size_t length) {
+  HANDLE handle = encoding == ENCODING_IDENTITY ? file->handle : file->variants[encoding].handle;
+  if (handle == INVALID_HANDLE_VALUE || length == 0) return NULL;
+
+  // 뷰가 섹션을 참조하므로 매핑 핸들은 바로 닫아도 됨
+  HANDLE mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping) return NULL;
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, length);
+  CloseHandle(mapping);
+  if (!view) return NULL;
+
+  // MAP_POPULATE/MADV_WILLNEED 대응, 페이지를 비동기로 미리 읽기 (실패해도 무시)
+  WIN32_MEMORY_RANGE_ENTRY range = {view, length};
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+
+  return view;
+}
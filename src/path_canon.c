@@ -0,0 +1,94 @@
+/*
+ * 요청 경로 정규화
+ * - 입력을 한 번만 읽고 출력 버퍼 위에서 점 세그먼트를 되감음 (복사, 재디코딩 없음)
+ */
+
+#include "path_canon.h"
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+// 16진수 문자 값 (아니면 -1)
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// 한 번의 순회로 디코딩, 구분자 정리, 점 세그먼트 처리, 금지 문자 검사
+// 결과는 document_root 기준 상대 경로 (PATH_SEPARATOR 구분, 앞뒤 구분자 없음)
+path_status canonicalize_path(const char *path, char *out, size_t out_size) {
+  if (!path || !*path) return PATH_EMPTY;
+  if (out_size < 2) return PATH_TOO_LONG;
+
+  size_t len = 0; // out에 쓴 길이 (완성된 컴포넌트 뒤에는 구분자가 붙어 있음)
+  size_t seg_start = 0; // 현재 컴포넌트 시작 위치
+  const char *src = path;
+
+  while (1) {
+    unsigned char c = (unsigned char) *src;
+    int separator = 0;
+
+    if (c == '\0') {
+      separator = 1;
+    } else if (c == '%') {
+      // %XX만 허용 (%uXXXX 같은 비표준 인코딩은 거부)
+      int hi = hex_value(src[1]);
+      int lo = hi < 0 ? -1 : hex_value(src[2]);
+      if (lo < 0) return PATH_BAD_ENCODING;
+      c = (unsigned char) (hi * 16 + lo);
+      src += 3;
+
+      // 인코딩된 NUL, 구분자는 거부, 디코딩 결과가 '%'면 이중 인코딩
+      if (c == 0 || c == '/' || c == '\\') return PATH_BAD_CHAR;
+      if (c == '%') return PATH_BAD_ENCODING;
+    } else if (c == '/' || c == '\\') {
+      separator = 1;
+      src++;
+    } else {
+      src++;
+    }
+
+    if (separator) {
+      size_t seg_len = len - seg_start;
+      const char *seg = out + seg_start;
+
+      if (seg_len == 1 && seg[0] == '.') {
+        // "." 제거
+        len = seg_start;
+      } else if (seg_len == 2 && seg[0] == '.' && seg[1] == '.') {
+        // ".." 은 이전 컴포넌트 제거, 루트 위로는 불가
+        if (seg_start == 0) return PATH_TRAVERSAL;
+        len = seg_start - 1;
+        while (len > 0 && out[len - 1] != PATH_SEPARATOR) len--;
+      } else if (seg_len > 0) {
+        // 숨김 파일, Windows가 끝의 '.'/공백을 잘라내는 별칭 이름 거부
+        if (seg[0] == '.' || seg[seg_len - 1] == '.' || seg[seg_len - 1] == ' ') {
+          return PATH_HIDDEN;
+        }
+        if (len + 1 >= out_size) return PATH_TOO_LONG;
+        out[len++] = PATH_SEPARATOR;
+      }
+      seg_start = len;
+
+      if (c == '\0') break;
+      continue;
+    }
+
+    // 제어 문자, 스트림/드라이브 구분자 ':', overlong UTF-8 선행 바이트 거부
+    if (c < 0x20 || c == 0x7F || c == ':') return PATH_BAD_CHAR;
+    if (c == 0xC0 || c == 0xC1) return PATH_BAD_ENCODING;
+
+    if (len + 1 >= out_size) return PATH_TOO_LONG;
+    out[len++] = (char) c;
+  }
+
+  // 마지막 구분자 제거
+  if (len > 0 && out[len - 1] == PATH_SEPARATOR) len--;
+  out[len] = '\0';
+  return PATH_OK;
+}
@@ -0,0 +1,41 @@
+#include "response_header.h"
+#include <stdio.h>
+
+int format_header_block(char *out,
+                        size_t out_size,
+                        const char *content_type,
+                        unsigned long long content_length,
+                        const char *content_encoding,
+                        int varies,
+                        const char *etag,
+                        const char *last_modified) {
+  // 압축 표현은 항상 Vary, 원본은 다른 표현이 있을 때만
+  char encoding_headers[128] = {0};
+  if (content_encoding) {
+    snprintf(encoding_headers, sizeof(encoding_headers),
+             "Content-Encoding: %s\r\n"
+             "Vary: Accept-Encoding\r\n",
+             content_encoding);
+  } else if (varies) {
+    snprintf(encoding_headers, sizeof(encoding_headers), "Vary: Accept-Encoding\r\n");
+  }
+
+  int length = snprintf(out, out_size,
+                        STATUS_LINE_200
+                        "Content-Type: %s\r\n"
+                        "Content-Length: %llu\r\n"
+                        "%s"
+                        "Cache-Control: public, max-age=86400\r\n"
+                        "ETag: %s\r\n"
+                        "Last-Modified: %s\r\n"
+                        "Accept-Ranges: bytes\r\n"
+                        "Connection: keep-alive\r\n"
+                        "X-Content-Type-Options: nosniff\r\n",
+                        content_type,
+                        content_length,
+                        encoding_headers,
+                        etag,
+                        last_modified);
+  if (length < 0 || (size_t) length >= out_size) return -1;
+  return length;
+}
@@ -10,7 +10,13 @@
 #include "config.h"
 #include "connection.h"
 #include "file_handler.h"
+#include "open_file_cache.h"
 #include "http_parser.h"
+#include "date_cache.h"
+#include "response_header.h"
+#include "file_stream.h"
+#include "slice_cache.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,6 +37,12 @@
 // 전역 서버 인스턴스
 http_server *g_server = NULL;
 
+// 크기 계층별 응답 수 (임계값 조정용)
+static volatile LONG tier_inline = 0; // 헤더와 본문이 연속된 작은 파일
+static volatile LONG tier_cached = 0; // 캐시나 번들에서 제공한 중간 크기 파일
+static volatile LONG tier_uncached = 0; // 읽었지만 캐시에 넣지 못한 파일
+static volatile LONG tier_large = 0; // 캐시를 거치지 않고 스트리밍/커널 전송한 큰 파일
+
 // 서버 초기화
 int server_init(http_server *server) {
     g_server = server;
@@ -85,6 +97,8 @@ int server_start(http_server *server) {
     // 메인 서버 루프
     while (server->running) {
         client_connection *client = server_accept_client(server);
+        date_cache_tick();
+        error_log_tick();
         if (client) {
             handle_connection(client);
             close_connection(client);
@@ -114,13 +128,13 @@ client_connection *server_accept_client(http_server *server) {
                                   &addr_len);
 
     if (client_socket == INVALID_SOCKET) {
-        fprintf(stderr, "Accept failed: %d\n", WSAGetLastError());
+        LOG_WARN("Accept failed: %d", WSAGetLastError());
         return NULL;
     }
 
-    printf("New client connected from %s:%d\n",
-           inet_ntoa(client_addr.sin_addr),
-           ntohs(client_addr.sin_port));
+    LOG_DEBUG("New client connected from %s:%d",
+              inet_ntoa(client_addr.sin_addr),
+              ntohs(client_addr.sin_port));
 
     return create_connection(client_socket,
                              client_addr,
@@ -217,6 +231,31 @@ range_request *parse_range_header(const char *range_header, size_t file_size) {
     return ranges;
 }
 
+// 여러 버퍼를 한 번의 WSASend로 전송 (일부만 보내진 경우 남은 부분 이어서 전송)
+static int send_buffers(SOCKET client_socket, WSABUF *buffers, DWORD count) {
+    while (count > 0) {
+        DWORD sent = 0;
+        if (WSASend(client_socket, buffers, count, &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+            return -1;
+        }
+        while (count > 0 && sent >= buffers->len) {
+            sent -= buffers->len;
+            buffers++;
+            count--;
+        }
+        if (count > 0) {
+            buffers->buf += sent;
+            buffers->len -= sent;
+        }
+    }
+    return 0;
+}
+
+void server_print_stats(void) {
+    printf("Size tiers: %ld inline, %ld cached, %ld uncached, %ld large\n",
+           (long) tier_inline, (long) tier_cached, (long) tier_uncached, (long) tier_large);
+}
+
 void handle_static_file(SOCKET client_socket, const http_request *req, const char *request_path) {
     if (!g_server) {
         error_context err = MAKE_ERROR_DETAIL(ERR_INTERNAL_ERROR,
@@ -229,18 +268,7 @@ void handle_static_file(SOCKET client_socket, const http_request *req, const cha
 
     optimize_socket(client_socket);
 
-    printf("\n=== Static File Request ===\n");
-    printf("Request path: %s\n", request_path);
-
-    // 경로 안전성 검사
-    if (!is_path_safe(request_path)) {
-        error_context err = MAKE_ERROR_DETAIL(ERR_ACCESS_DENIED,
-                                              "Access Denied",
-                                              request_path);
-        log_error(&err);
-        send_error_response(client_socket, &err);
-        return;
-    }
+    LOG_DEBUG("Static file request: %s", request_path);
 
     // index.html 처리
     const char *file_path = request_path;
@@ -248,7 +276,40 @@ void handle_static_file(SOCKET client_socket, const http_request *req, const cha
         file_path = "/index.html";
     }
 
-    file_result file = read_file(g_server->config.document_root, file_path);
+    // HEAD는 GET과 같은 헤더를 만들고 본문은 보내지 않음
+    // (ETag와 표현은 메타데이터로 정해지므로 읽지 않음, 즉석 압축 표현만 길이를 알기 위해 압축)
+    int head_only = req->method == HTTP_HEAD;
+
+    // 클라이언트가 허용하는 압축 표현
+    int accept_encodings = parse_accept_encoding(get_header_value(req, "Accept-Encoding"));
+
+    // 메타데이터만 먼저 조회 (조건부 요청이 맞으면 디스크 읽기 생략)
+    file_result file = lookup_file(g_server->config.document_root, file_path, accept_encodings);
+
+    // 조건부 요청 (If-None-Match가 있으면 If-Modified-Since는 무시)
+    const char *if_none_match = get_header_value(req, "If-None-Match");
+    const char *if_modified = get_header_value(req, "If-Modified-Since");
+    int not_modified = 0;
+    int streaming = 0;
+    if (file.status_code == 200) {
+        if (if_none_match) {
+            not_modified = etag_list_matches(if_none_match, file.etag);
+        } else if (if_modified) {
+            time_t since = parse_http_date(if_modified);
+            not_modified = since != (time_t) -1 && file.mtime <= since;
+        }
+
+        // 캐시에 없는 큰 파일은 메모리에 올리지 않고 스트리밍 (매핑 캐시를 써도 같은 기준)
+        streaming = !head_only && !file.data && file.size >= g_server->config.stream_min_size;
+
+        int need_data = !head_only || (file.dynamic && !file.data);
+        if (!not_modified && !streaming && need_data &&
+            load_file_data(&file) && if_none_match) {
+            // 압축 이득이 없어 원본 표현으로 바뀌었으면 다시 비교
+            not_modified = etag_list_matches(if_none_match, file.etag);
+        }
+    }
+
     if (file.status_code != 200) {
         error_context err;
         if (file.status_code == 404) {
@@ -262,60 +323,101 @@ void handle_static_file(SOCKET client_socket, const http_request *req, const cha
                                     "Failed to read file",
                                     "Error occurred while reading the requested file");
         }
-        log_error(&err);
-        send_error_response(client_socket, &err);
+        // 부정 캐시 히트는 처음 한 번만 기록
+        if (!file.negative_hit) {
+            log_error(&err);
+        }
+        if (head_only) {
+            send_error_headers(client_socket, &err);
+        } else {
+            send_error_response(client_socket, &err);
+        }
+        free_file_result(&file);
         return;
     }
 
-    // 전체 경로 생성
-    char full_path[1024];
-    snprintf(full_path,
-             sizeof(full_path),
-             "%s%c%s",
-             g_server->config.document_root,
-             PATH_SEPARATOR,
-             file_path[0] == '/' ? file_path + 1 : file_path);
-
-    // 마지막 수정 시간 확인
-    struct stat file_stat;
-    char last_modified[50] = {0};
-    if (stat(full_path, &file_stat) == 0) {
-        time_t gmt_time = file_stat.st_mtime;
-        struct tm *gmt = gmtime(&gmt_time);
-        if (gmt) {
-            strftime(last_modified,
-                     sizeof(last_modified),
-                     "%a, %d %b %Y %H:%M:%S GMT",
-                     gmt);
-        }
+    // 마지막 수정 시간 (열린 파일 캐시나 번들에 미리 생성된 값)
+    const char *last_modified = file.last_modified;
+
+    // 압축 표현 헤더 (Range도 압축된 바이트 기준)
+    char encoding_headers[128] = {0};
+    if (file.encoding != ENCODING_IDENTITY) {
+        snprintf(encoding_headers,
+                 sizeof(encoding_headers),
+                 "Content-Encoding: %s\r\n"
+                 "Vary: Accept-Encoding\r\n",
+                 encoding_name(file.encoding));
+    } else if (file.varies) {
+        snprintf(encoding_headers, sizeof(encoding_headers), "Vary: Accept-Encoding\r\n");
     }
 
-    // If-Modified-Since 처리
-    const char *if_modified = get_header_value(req, "If-Modified-Since");
-    if (if_modified && last_modified[0] && strcmp(if_modified, last_modified) == 0) {
-        const char *not_modified =
-                "HTTP/1.1 304 Not Modified\r\n"
-                "Cache-Control: public, max-age=86400\r\n"
-                "\r\n";
-        send(client_socket, not_modified, strlen(not_modified), 0);
+    if (not_modified) {
+        char not_modified_header[512];
+        snprintf(not_modified_header,
+                 sizeof(not_modified_header),
+                 "HTTP/1.1 304 Not Modified\r\n"
+                 "Date: %s\r\n"
+                 "ETag: %s\r\n"
+                 "Last-Modified: %s\r\n"
+                 "%s"
+                 "Cache-Control: public, max-age=86400\r\n"
+                 "\r\n",
+                 http_date_now(),
+                 file.etag,
+                 last_modified,
+                 file.varies ? "Vary: Accept-Encoding\r\n" : "");
+        send(client_socket, not_modified_header, strlen(not_modified_header), 0);
         free_file_result(&file);
         return;
     }
 
-    // Range 요청 처리
+    // Range 요청 처리 (HEAD는 전체 표현의 헤더만 반환)
     const char *range_header = get_header_value(req, "Range");
     range_request *ranges = NULL;
-    if (range_header) {
+    if (range_header && !head_only) {
         ranges = parse_range_header(range_header, file.size);
     }
 
+    // 큰 파일의 Range 요청은 슬라이스 캐시에서 조립 (자주 찾는 구간만 메모리에 유지)
+    int sliced = streaming && ranges && ranges->count > 0 && slice_cache_enabled();
+
+    // 스트림은 헤더를 보내기 전에 열어 실패 시 에러 응답 가능
+    // 커널 전송을 쓸 수 없으면 미리 읽기 스트림으로 전송
+    file_stream *stream = NULL;
+    int transmit = 0;
+    if (streaming && !sliced) {
+        unsigned long long offset = 0;
+        unsigned long long length = file.size;
+        if (ranges && ranges->count > 0) {
+            offset = ranges->parts[0].start;
+            length = ranges->parts[0].end - ranges->parts[0].start + 1;
+        }
+        if (g_server->config.transmit_file) {
+            stream = file_stream_open_transmit(file.file_ref, file.encoding, offset, length);
+            transmit = stream != NULL;
+        }
+        if (!stream) {
+            stream = file_stream_open(file.file_ref, file.encoding, offset, length);
+        }
+        if (!stream) {
+            error_context err = MAKE_ERROR_DETAIL(ERR_INTERNAL_ERROR,
+                                                  "Failed to read file",
+                                                  "Could not open file for streaming");
+            log_error(&err);
+            send_error_response(client_socket, &err);
+            goto cleanup;
+        }
+    }
+
     // 성능 측정을 위한 타이머 초기화
     LARGE_INTEGER freq, start_time;
     QueryPerformanceFrequency(&freq);
     QueryPerformanceCounter(&start_time);
 
-    int last_percent = -1;
     char header[1024];
+    const char *header_data = header;
+    size_t header_length = 0;
+    const cache_header *inline_response = NULL;
     if (ranges && ranges->count > 0) {
         // 범위 요청 처리
         range_part *part = &ranges->parts[0];
@@ -327,38 +429,177 @@ void handle_static_file(SOCKET client_socket, const http_request *req, const cha
                  "Content-Type: %s\r\n"
                  "Content-Length: %llu\r\n"
                  "Content-Range: bytes %llu-%llu/%llu\r\n"
+                 "%s"
                  "Cache-Control: public, max-age=86400\r\n"
+                 "ETag: %s\r\n"
                  "Last-Modified: %s\r\n"
                  "Accept-Ranges: bytes\r\n"
                  "Connection: keep-alive\r\n"
-                 "X-Content-Type-Options: nosniff\r\n"
-                 "\r\n",
+                 "X-Content-Type-Options: nosniff\r\n",
                  file.content_type,
                  (unsigned long long) content_length,
                  (unsigned long long) part->start,
                  (unsigned long long) part->end,
                  (unsigned long long) file.size,
+                 encoding_headers,
+                 file.etag,
                  last_modified);
+        header_length = strlen(header);
     } else {
-        // 전체 파일 요청
-        snprintf(header,
-                 sizeof(header),
-                 "HTTP/1.1 200 OK\r\n"
-                 "Content-Type: %s\r\n"
-                 "Content-Length: %llu\r\n"
-                 "Cache-Control: public, max-age=86400\r\n"
-                 "Last-Modified: %s\r\n"
-                 "Accept-Ranges: bytes\r\n"
-                 "Connection: keep-alive\r\n"
-                 "X-Content-Type-Options: nosniff\r\n"
-                 "\r\n",
-                 file.content_type,
-                 (unsigned long long) file.size,
-                 last_modified);
+        // 작은 파일은 헤더와 본문이 연속된 블록, 그 외에는 번들이나 캐시 엔트리의 미리 만든 헤더 사용
+        if (!head_only && !streaming) {
+            inline_response = cache_get_inline_response(file.cache_ref, &file, g_server->config.inline_max_size);
+        }
+        const cache_header *prebuilt = file.header_block || inline_response ? NULL : cache_get_header(file.cache_ref, &file);
+        if (inline_response) {
+            header_data = STATUS_LINE_200;
+            header_length = sizeof(STATUS_LINE_200) - 1;
+        } else if (file.header_block) {
+            header_data = file.header_block;
+            header_length = file.header_length;
+        } else if (prebuilt) {
+            header_data = prebuilt->data;
+            header_length = prebuilt->length;
+        } else {
+            int length = format_header_block(header, sizeof(header),
+                                             file.content_type,
+                                             (unsigned long long) file.size,
+                                             file.encoding != ENCODING_IDENTITY ? encoding_name(file.encoding) : NULL,
+                                             file.varies,
+                                             file.etag,
+                                             last_modified);
+            header_length = length < 0 ? 0 : (size_t) length;
+        }
     }
 
-    printf("\n=== Response Headers ===\n%s", header);
-    send(client_socket, header, strlen(header), 0);
+    // 헤더 끝 (현재 초의 Date만 복사해 붙임)
+    char header_end[] = "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n";
+    memcpy(header_end + 6, http_date_now(), HTTP_DATE_LEN);
+
+    // 헤더 블록 + 헤더 끝, 작은 파일은 본문까지 한 번에 전송
+    WSABUF buffers[3];
+    DWORD buffer_count = 2;
+    buffers[0].buf = (char *) header_data;
+    buffers[0].len = (ULONG) header_length;
+    buffers[1].buf = header_end;
+    buffers[1].len = sizeof(header_end) - 1;
+
+    int body_included = !head_only && !streaming && !(ranges && ranges->count > 0) && file.size <= CHUNK_SIZE;
+    if (inline_response) {
+        // 상태 줄 + Date 다음에 나머지 헤더, 빈 줄, 본문이 이어진 블록 하나
+        buffers[1].len -= 2;
+        buffers[2].buf = (char *) inline_response->data;
+        buffers[2].len = (ULONG) inline_response->length;
+        buffer_count = 3;
+        body_included = 1;
+        LOG_DEBUG("Inline response: %s, %zu bytes", file_path, file.size);
+    } else {
+        LOG_DEBUG("Response headers: %zu bytes", header_length + sizeof(header_end) - 1);
+        if (body_included && file.size > 0) {
+            buffers[2].buf = file.data;
+            buffers[2].len = (ULONG) file.size;
+            buffer_count = 3;
+        }
+    }
+
+    // 크기 계층 집계
+    if (inline_response) {
+        InterlockedIncrement(&tier_inline);
+    } else if (streaming) {
+        InterlockedIncrement(&tier_large);
+    } else if (file.cache_ref || file.from_bundle) {
+        InterlockedIncrement(&tier_cached);
+    } else {
+        InterlockedIncrement(&tier_uncached);
+    }
+
+    if (send_buffers(client_socket, buffers, buffer_count) != 0) {
+        char error_detail[64];
+        snprintf(error_detail, sizeof(error_detail), "Socket error %d", WSAGetLastError());
+        error_context err = MAKE_ERROR_DETAIL(ERR_SOCKET_ERROR, "Failed to send response", error_detail);
+        log_error(&err);
+        goto cleanup;
+    }
+    if (head_only) {
+        goto cleanup;
+    }
+    if (body_included) {
+        LOG_DEBUG("Sent %zu bytes with headers", file.size);
+        goto cleanup;
+    }
+
+    // 슬라이스 단위 전송 (캐시에 없는 슬라이스만 디스크에서 읽음)
+    if (sliced) {
+        unsigned long long position = ranges->parts[0].start;
+        unsigned long long end = ranges->parts[0].end + 1;
+        while (position < end) {
+            slice_entry *slice = slice_cache_get(file.file_ref, file.encoding, position / SLICE_SIZE);
+            if (!slice) {
+                // 헤더는 이미 보냈으므로 연결 종료로 잘린 응답을 알림
+                LOG_ERROR("Slice read failed", file_path);
+                goto cleanup;
+            }
+
+            size_t slice_length;
+            const char *data = slice_data(slice, &slice_length);
+            size_t offset = (size_t) (position % SLICE_SIZE);
+            size_t length = (size_t) min((unsigned long long) (slice_length - offset), end - position);
+
+            WSABUF buffer;
+            buffer.buf = (char *) data + offset;
+            buffer.len = (ULONG) length;
+            int send_failed = send_buffers(client_socket, &buffer, 1) != 0;
+            slice_cache_release(slice);
+            if (send_failed) {
+                char error_detail[64];
+                snprintf(error_detail, sizeof(error_detail), "Socket error %d", WSAGetLastError());
+                error_context err = MAKE_ERROR_DETAIL(ERR_SOCKET_ERROR, "Failed to send file data", error_detail);
+                log_error(&err);
+                goto cleanup;
+            }
+            position += length;
+        }
+        LOG_DEBUG("Sent %llu bytes from slices", end - ranges->parts[0].start);
+        goto cleanup;
+    }
+
+    // 커널 전송 (파일에서 소켓으로 복사 없이)
+    if (transmit) {
+        if (file_stream_transmit(stream, client_socket) != 0) {
+            // 헤더는 이미 보냈으므로 연결 종료로 잘린 응답을 알림
+            LOG_ERROR("TransmitFile failed", file_path);
+        } else {
+            LOG_DEBUG("Transmitted %zu bytes", ranges && ranges->count > 0 ?
+                      ranges->parts[0].end - ranges->parts[0].start + 1 : file.size);
+        }
+        goto cleanup;
+    }
+
+    // 스트리밍 전송 (블록을 보내는 동안 다음 블록들을 읽는 중)
+    if (stream) {
+        const char *block;
+        size_t block_length;
+        unsigned long long streamed = 0;
+        while ((block = file_stream_next(stream, &block_length)) != NULL) {
+            WSABUF buffer;
+            buffer.buf = (char *) block;
+            buffer.len = (ULONG) block_length;
+            if (send_buffers(client_socket, &buffer, 1) != 0) {
+                char error_detail[64];
+                snprintf(error_detail, sizeof(error_detail), "Socket error %d", WSAGetLastError());
+                error_context err = MAKE_ERROR_DETAIL(ERR_SOCKET_ERROR, "Failed to send file data", error_detail);
+                log_error(&err);
+                goto cleanup;
+            }
+            streamed += block_length;
+        }
+        if (file_stream_failed(stream)) {
+            // 헤더는 이미 보냈으므로 연결 종료로 잘린 응답을 알림
+            LOG_ERROR("Streaming read failed", file_path);
+        }
+        LOG_DEBUG("Streamed %llu bytes", streamed);
+        goto cleanup;
+    }
 
     // 파일 데이터 전송
     const char *current_pos = file.data;
@@ -399,10 +640,9 @@ void handle_static_file(SOCKET client_socket, const http_request *req, const cha
 
                 if (error == WSAECONNRESET || error == WSAECONNABORTED) {
                     if (retry_count < MAX_RETRIES) {
-                        fprintf(stderr,
-                                "Connection reset, retrying (%d/%d)...\n",
-                                retry_count + 1,
-                                MAX_RETRIES);
+                        LOG_WARN("Connection reset, retrying (%d/%d)...",
+                                 retry_count + 1,
+                                 MAX_RETRIES);
                         Sleep(1000);
                         retry_count++;
                         continue;
@@ -423,33 +663,20 @@ void handle_static_file(SOCKET client_socket, const http_request *req, const cha
             sent += result;
             total_sent += result;
             retry_count = 0;
-
-            // 진행률 및 속도 계산
-            int current_percent = (int) ((total_sent * 100) /
-                                         (ranges ? (ranges->parts[0].end - ranges->parts[0].start + 1) : file.size));
-
-            if (current_percent != last_percent) {
-                LARGE_INTEGER current_time;
-                QueryPerformanceCounter(&current_time);
-                double elapsed = (double) (current_time.QuadPart - start_time.QuadPart) / freq.QuadPart;
-                double speed = elapsed > 0 ? (total_sent / (1024.0 * 1024.0)) / elapsed : 0;
-
-                printf("\rProgress: %3d%% (%zu/%zu bytes), %.2f MB/s",
-                       current_percent,
-                       total_sent,
-                       ranges ? (ranges->parts[0].end - ranges->parts[0].start + 1) : file.size,
-                       speed);
-                fflush(stdout);
-                last_percent = current_percent;
-            }
         }
         current_pos += chunk_size;
         remaining -= chunk_size;
     }
 
-    printf("\nTransfer completed: %zu bytes sent\n", total_sent);
+    // 전송 속도 (진행률은 청크마다 출력하지 않고 끝에 한 번)
+    LARGE_INTEGER end_time;
+    QueryPerformanceCounter(&end_time);
+    double elapsed = (double) (end_time.QuadPart - start_time.QuadPart) / freq.QuadPart;
+    LOG_DEBUG("Transfer completed: %zu bytes sent, %.2f MB/s",
+              total_sent, elapsed > 0 ? (total_sent / (1024.0 * 1024.0)) / elapsed : 0);
 
 cleanup:
+    file_stream_close(stream);
     if (ranges) free(ranges);
     free_file_result(&file);
 }
@@ -0,0 +1,212 @@
+/*
+ * 슬라이스 캐시
+ * - 해시 테이블 + LRU 리스트 하나를 SRWLOCK으로 보호 (조회는 큰 구간 단위라 경합이 적음)
+ * - 파일이 바뀌면 수정 시간, 크기가 키에 들어 있어 이전 슬라이스는 더 이상 맞지 않고 LRU로 밀려남
+ * - 디스크 읽기는 락 밖에서, 같은 슬라이스를 동시에 읽었으면 먼저 넣은 쪽을 사용
+ */
+
+#include "slice_cache.h"
+#include "open_file_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SLICE_BUCKET_COUNT 1024
+
+struct slice_entry {
+  unsigned long long file_id;
+  unsigned long long mtime_ticks; // 같은 초 안의 재작성도 구분
+  unsigned long long file_size; // 표현 크기
+  content_encoding encoding;
+  unsigned long long index;
+  size_t length; // 데이터 길이
+  volatile LONG ref_count; // 캐시 보유분 1 + 사용 중인 요청 수
+  struct slice_entry *hash_next;
+  struct slice_entry *lru_prev; // head가 최근 사용
+  struct slice_entry *lru_next;
+  char data[];
+};
+
+static SRWLOCK slice_lock = SRWLOCK_INIT;
+static slice_entry **buckets = NULL;
+static slice_entry *lru_head = NULL;
+static slice_entry *lru_tail = NULL;
+static size_t slice_budget = 0;
+static size_t slice_bytes = 0; // 캐시된 데이터 합
+
+// 지표
+static volatile LONG slice_hits = 0;
+static volatile LONG slice_misses = 0;
+static volatile LONG slice_evictions = 0;
+
+static unsigned int slice_hash(unsigned long long file_id, content_encoding encoding, unsigned long long index) {
+  unsigned long long hash = file_id * 0x9E3779B97F4A7C15ULL;
+  hash ^= index + 0x632BE59BD9B4E019ULL + (hash << 6) + (hash >> 2);
+  hash ^= (unsigned long long) encoding;
+  return (unsigned int) (hash ^ (hash >> 32)) % SLICE_BUCKET_COUNT;
+}
+
+static int slice_matches(const slice_entry *slice,
+                         const open_file *file,
+                         content_encoding encoding,
+                         unsigned long long index) {
+  return slice->file_id == file->file_id && slice->mtime_ticks == file->mtime_ticks &&
+         slice->file_size == open_file_size(file, encoding) &&
+         slice->encoding == encoding && slice->index == index;
+}
+
+// LRU 맨 앞으로 (락 보유 상태)
+static void lru_unlink(slice_entry *slice) {
+  if (slice->lru_prev) slice->lru_prev->lru_next = slice->lru_next;
+  else lru_head = slice->lru_next;
+  if (slice->lru_next) slice->lru_next->lru_prev = slice->lru_prev;
+  else lru_tail = slice->lru_prev;
+  slice->lru_prev = NULL;
+  slice->lru_next = NULL;
+}
+
+static void lru_push_front(slice_entry *slice) {
+  slice->lru_next = lru_head;
+  if (lru_head) lru_head->lru_prev = slice;
+  lru_head = slice;
+  if (!lru_tail) lru_tail = slice;
+}
+
+// 테이블에서 제거 (락 보유 상태, 캐시 보유 참조는 호출자가 반납)
+static void slice_unlink(slice_entry *slice) {
+  slice_entry **link = &buckets[slice_hash(slice->file_id, slice->encoding, slice->index)];
+  while (*link != slice) link = &(*link)->hash_next;
+  *link = slice->hash_next;
+  lru_unlink(slice);
+  slice_bytes -= slice->length;
+}
+
+int slice_cache_init(size_t budget) {
+  if (budget == 0) return 0;
+  buckets = (slice_entry **) calloc(SLICE_BUCKET_COUNT, sizeof(slice_entry *));
+  if (!buckets) return -1;
+  slice_budget = budget;
+  return 0;
+}
+
+void slice_cache_cleanup(void) {
+  AcquireSRWLockExclusive(&slice_lock);
+  slice_entry *slice = lru_head;
+  while (slice) {
+    slice_entry *next = slice->lru_next;
+    slice_cache_release(slice);
+    slice = next;
+  }
+  lru_head = NULL;
+  lru_tail = NULL;
+  slice_bytes = 0;
+  free(buckets);
+  buckets = NULL;
+  slice_budget = 0;
+  ReleaseSRWLockExclusive(&slice_lock);
+}
+
+int slice_cache_enabled(void) {
+  return buckets != NULL;
+}
+
+void slice_cache_print_stats(void) {
+  if (!buckets) return;
+  printf("Slice Cache: %ld hits, %ld misses, %ld evictions, %zu/%zu bytes\n",
+         (long) slice_hits, (long) slice_misses, (long) slice_evictions,
+         slice_bytes, slice_budget);
+}
+
+// 찾으면 참조 획득 후 LRU 갱신 (락 보유 상태)
+static slice_entry *find_locked(const open_file *file, content_encoding encoding, unsigned long long index) {
+  slice_entry *slice = buckets[slice_hash(file->file_id, encoding, index)];
+  while (slice && !slice_matches(slice, file, encoding, index)) {
+    slice = slice->hash_next;
+  }
+  if (slice) {
+    InterlockedIncrement(&slice->ref_count);
+    lru_unlink(slice);
+    lru_push_front(slice);
+  }
+  return slice;
+}
+
+slice_entry *slice_cache_get(const open_file *file, content_encoding encoding, unsigned long long index) {
+  if (!buckets || !file) return NULL;
+
+  unsigned long long file_size = open_file_size(file, encoding);
+  unsigned long long offset = index * SLICE_SIZE;
+  if (offset >= file_size) return NULL;
+
+  AcquireSRWLockExclusive(&slice_lock);
+  slice_entry *slice = find_locked(file, encoding, index);
+  ReleaseSRWLockExclusive(&slice_lock);
+  if (slice) {
+    InterlockedIncrement(&slice_hits);
+    return slice;
+  }
+  InterlockedIncrement(&slice_misses);
+
+  // 락 밖에서 디스크 읽기 (마지막 슬라이스는 파일 끝까지)
+  size_t length = (size_t) min((unsigned long long) SLICE_SIZE, file_size - offset);
+  slice = (slice_entry *) malloc(sizeof(slice_entry) + length);
+  if (!slice) return NULL;
+  if (open_file_read(file, encoding, slice->data, length, offset) != length) {
+    free(slice);
+    return NULL;
+  }
+  slice->file_id = file->file_id;
+  slice->mtime_ticks = file->mtime_ticks;
+  slice->file_size = file_size;
+  slice->encoding = encoding;
+  slice->index = index;
+  slice->length = length;
+  slice->ref_count = 2; // 캐시 + 호출자
+  slice->lru_prev = NULL;
+  slice->lru_next = NULL;
+
+  AcquireSRWLockExclusive(&slice_lock);
+  slice_entry *existing = find_locked(file, encoding, index);
+  slice_entry *evicted = NULL;
+  if (!existing && length <= slice_budget) {
+    // 예산을 넘으면 오래된 슬라이스부터 제거 (반납은 락 밖에서)
+    while (slice_bytes + length > slice_budget && lru_tail) {
+      slice_entry *victim = lru_tail;
+      slice_unlink(victim);
+      victim->hash_next = evicted;
+      evicted = victim;
+      InterlockedIncrement(&slice_evictions);
+    }
+    slice_entry **bucket = &buckets[slice_hash(file->file_id, encoding, index)];
+    slice->hash_next = *bucket;
+    *bucket = slice;
+    lru_push_front(slice);
+    slice_bytes += length;
+  } else if (!existing) {
+    slice->ref_count = 1; // 예산보다 큰 슬라이스는 캐시하지 않고 이번 요청만 사용
+  }
+  ReleaseSRWLockExclusive(&slice_lock);
+
+  while (evicted) {
+    slice_entry *next = evicted->hash_next;
+    slice_cache_release(evicted);
+    evicted = next;
+  }
+
+  // 동시에 같은 슬라이스를 읽은 요청이 먼저 넣었으면 그쪽 사용
+  if (existing) {
+    free(slice);
+    return existing;
+  }
+  return slice;
+}
+
+void slice_cache_release(slice_entry *slice) {
+  if (slice && InterlockedDecrement(&slice->ref_count) == 0) {
+    free(slice);
+  }
+}
+
+const char *slice_data(const slice_entry *slice, size_t *length) {
+  *length = slice->length;
+  return slice->data;
+}
@@ -0,0 +1,131 @@
+/*
+ * 업로드 파일 쓰기
+ * - 임시 파일 이름은 '.'으로 시작해 경로 검사에서 숨김 파일로 거부되므로 쓰는 중에는 제공되지 않음
+ * - 같은 볼륨이므로 MoveFileEx(MOVEFILE_REPLACE_EXISTING)가 이름만 바꾸는 원자적 교체
+ */
+
+#include "upload_file.h"
+#include "file_handler.h"
+#include "logger.h"
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+struct upload_file {
+  HANDLE handle; // 임시 파일
+  char temp_path[PATH_MAX];
+  char target_path[PATH_MAX];
+  unsigned long long written; // 기록한 바이트 수
+};
+
+static volatile LONG upload_counter = 0; // 임시 파일 이름 구분용
+
+// 같은 디렉토리의 숨김 임시 파일 생성 (미리 할당)
+static int create_temp_file(upload_file *upload, unsigned long long expected_size) {
+  upload->handle = CreateFileA(upload->temp_path,
+                               GENERIC_WRITE | DELETE,
+                               0,
+                               NULL,
+                               CREATE_NEW,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                               NULL);
+  if (upload->handle == INVALID_HANDLE_VALUE) return -1;
+
+  // 미리 할당 (조각화 방지, 디스크가 부족하면 받기 전에 실패)
+  if (expected_size > 0) {
+    FILE_ALLOCATION_INFO allocation;
+    allocation.AllocationSize.QuadPart = (LONGLONG) expected_size;
+    if (!SetFileInformationByHandle(upload->handle, FileAllocationInfo, &allocation, sizeof(allocation))) {
+      DWORD error = GetLastError();
+      if (error == ERROR_DISK_FULL) {
+        CloseHandle(upload->handle);
+        DeleteFileA(upload->temp_path);
+        upload->handle = INVALID_HANDLE_VALUE;
+        return -1;
+      }
+      // 미리 할당을 지원하지 않는 파일 시스템은 그대로 진행
+    }
+  }
+  return 0;
+}
+
+upload_file *upload_begin(const char *target_path, unsigned long long expected_size) {
+  upload_file *upload = (upload_file *) calloc(1, sizeof(upload_file));
+  if (!upload) return NULL;
+
+  // 같은 디렉토리의 숨김 임시 파일
+  const char *name = strrchr(target_path, PATH_SEPARATOR);
+  size_t dir_length = name ? (size_t) (name - target_path) + 1 : 0;
+  int length = snprintf(upload->temp_path, sizeof(upload->temp_path), "%.*s.upload-%lu-%ld.tmp",
+                        (int) dir_length, target_path,
+                        GetCurrentProcessId(), InterlockedIncrement(&upload_counter));
+  if (length < 0 || (size_t) length >= sizeof(upload->temp_path) ||
+      strlen(target_path) >= sizeof(upload->target_path)) {
+    free(upload);
+    return NULL;
+  }
+  strcpy(upload->target_path, target_path);
+
+  if (create_temp_file(upload, expected_size) != 0) {
+    free(upload);
+    return NULL;
+  }
+  return upload;
+}
+
+int upload_write(upload_file *upload, const void *data, size_t length) {
+  if (!upload) return -1;
+  const char *bytes = (const char *) data;
+
+  while (length > 0) {
+    DWORD chunk = (DWORD) (length < 0x40000000 ? length : 0x40000000);
+    DWORD written = 0;
+    if (!WriteFile(upload->handle, bytes, chunk, &written, NULL) || written == 0) return -1;
+    bytes += written;
+    length -= written;
+    upload->written += written;
+  }
+  return 0;
+}
+
+unsigned long long upload_size(const upload_file *upload) {
+  return upload ? upload->written : 0;
+}
+
+int upload_commit(upload_file *upload, int sync) {
+  if (!upload) return -1;
+
+  // 미리 할당한 공간 중 쓰지 않은 부분 잘라내기
+  FILE_END_OF_FILE_INFO end_of_file;
+  end_of_file.EndOfFile.QuadPart = (LONGLONG) upload->written;
+  int ok = SetFileInformationByHandle(upload->handle, FileEndOfFileInfo, &end_of_file, sizeof(end_of_file));
+
+  if (ok && sync) ok = FlushFileBuffers(upload->handle);
+  if (!CloseHandle(upload->handle)) ok = 0;
+  upload->handle = INVALID_HANDLE_VALUE;
+
+  if (ok) {
+    ok = MoveFileExA(upload->temp_path, upload->target_path,
+                     MOVEFILE_REPLACE_EXISTING | (sync ? MOVEFILE_WRITE_THROUGH : 0));
+  }
+  if (!ok) {
+    LOG_WARN("Upload commit failed for %s: %lu", upload->target_path, GetLastError());
+    DeleteFileA(upload->temp_path);
+  }
+  free(upload);
+  return ok ? 0 : -1;
+}
+
+void upload_abort(upload_file *upload) {
+  if (!upload) return;
+  if (upload->handle != INVALID_HANDLE_VALUE) CloseHandle(upload->handle);
+  DeleteFileA(upload->temp_path);
+  free(upload);
+}
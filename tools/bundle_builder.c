@@ -0,0 +1,446 @@
+/*
+ * 정적 파일 번들 생성 도구
+ * 사용법: bundle_builder <static 폴더> <출력 파일> [mime.types]
+ * 1. 폴더를 재귀 스캔 (숨김/시스템 파일, 링크, .gz/.br 사이드카 자체는 제외)
+ * 2. 표현별 데이터를 페이지 정렬로 기록 (사이드카가 없으면 텍스트 파일은 압축)
+ * 3. 문자열, 변위 테이블, 엔트리 테이블을 뒤에 붙이고 마지막에 헤더 기록
+ *
+ * 파일 배치: [헤더][데이터 ...][문자열][변위 테이블][엔트리 테이블]
+ */
+
+#include "bundle.h"
+#include "compress.h"
+#include "hash.h"
+#include "mime_types.h"
+#include "response_header.h"
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#define MAX_DISPLACEMENT (1u << 20) // 버킷당 변위 시도 횟수 (넘으면 버킷 수를 늘려 재시도)
+
+static const char *const ENCODING_NAMES[ENCODING_COUNT] = {NULL, "gzip", "br"};
+static const char *const ENCODING_SUFFIXES[ENCODING_COUNT] = {"", ".gz", ".br"};
+
+typedef struct {
+  char key[PATH_MAX]; // 소문자 상대 경로
+  char path[PATH_MAX]; // 디스크 전체 경로
+  bundle_entry entry; // 문자열 오프셋은 문자열 영역 기준 (마지막에 보정)
+} build_entry;
+
+static build_entry *items = NULL;
+static size_t item_count = 0;
+static size_t item_capacity = 0;
+
+// 문자열 영역 (헤더 블록, 키, Content-Type, Last-Modified)
+static char *strings = NULL;
+static size_t strings_length = 0;
+static size_t strings_capacity = 0;
+
+static FILE *output = NULL;
+static unsigned long long output_offset = 0;
+
+static unsigned long long append_string(const char *text, size_t length) {
+  if (strings_length + length + 1 > strings_capacity) {
+    size_t capacity = strings_capacity ? strings_capacity * 2 : 64 * 1024;
+    while (capacity < strings_length + length + 1) capacity *= 2;
+    char *grown = realloc(strings, capacity);
+    if (!grown) {
+      fprintf(stderr, "Out of memory\n");
+      exit(1);
+    }
+    strings = grown;
+    strings_capacity = capacity;
+  }
+
+  unsigned long long offset = strings_length;
+  memcpy(strings + strings_length, text, length);
+  strings[strings_length + length] = '\0';
+  strings_length += length + 1;
+  return offset;
+}
+
+static int write_bytes(const void *data, size_t length) {
+  if (length > 0 && fwrite(data, 1, length, output) != length) return -1;
+  output_offset += length;
+  return 0;
+}
+
+// alignment 경계까지 0으로 채움
+static int write_padding(unsigned long long alignment) {
+  static const char zeros[BUNDLE_ALIGN] = {0};
+  size_t padding = (size_t) ((alignment - output_offset % alignment) % alignment);
+  return write_bytes(zeros, padding);
+}
+
+static char *read_whole_file(const char *path, size_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return NULL;
+
+  char *data = NULL;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    long size = ftell(file);
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+      data = malloc((size_t) size + 1);
+      if (data && fread(data, 1, (size_t) size, file) != (size_t) size) {
+        free(data);
+        data = NULL;
+      }
+      *length = (size_t) size;
+    }
+  }
+  fclose(file);
+  return data;
+}
+
+// 서버의 date_cache와 같은 형식 (로케일과 무관한 요일/월 이름)
+static void format_http_date(time_t value, char *out, size_t size) {
+  static const char DAY_NAMES[7][4] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+  static const char MONTH_NAMES[12][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+
+  struct tm gmt;
+  gmtime_s(&gmt, &value);
+  strftime(out, size, "Day, %d Mon %Y %H:%M:%S GMT", &gmt);
+  memcpy(out, DAY_NAMES[gmt.tm_wday], 3);
+  memcpy(out + 8, MONTH_NAMES[gmt.tm_mon], 3);
+}
+
+// 표현 하나 기록 (데이터, ETag, 헤더 블록)
+static int write_representation(build_entry *item,
+                                content_encoding encoding,
+                                const char *data,
+                                size_t length,
+                                const char *content_type,
+                                const char *last_modified) {
+  bundle_representation *representation = &item->entry.representations[encoding];
+
+  if (write_padding(BUNDLE_ALIGN) != 0) return -1;
+  representation->data_offset = output_offset;
+  representation->data_length = length;
+  representation->present = 1;
+  if (write_bytes(data, length) != 0) return -1;
+
+  snprintf(representation->etag, sizeof(representation->etag), "\"%016llx\"", hash64(data, length, 0));
+
+  // Vary는 압축 표현이 모두 정해진 뒤 다시 만들 수 있도록 원본은 나중에 기록
+  if (encoding == ENCODING_IDENTITY) return 0;
+
+  char header[1024];
+  int header_length = format_header_block(header, sizeof(header), content_type,
+                                          (unsigned long long) length, ENCODING_NAMES[encoding],
+                                          1, representation->etag, last_modified);
+  if (header_length < 0) return -1;
+  representation->header_offset = append_string(header, (size_t) header_length);
+  representation->header_length = (unsigned int) header_length;
+  return 0;
+}
+
+static int pack_file(build_entry *item, time_t mtime) {
+  size_t length = 0;
+  char *data = read_whole_file(item->path, &length);
+  if (!data) {
+    fprintf(stderr, "Failed to read %s\n", item->path);
+    return -1;
+  }
+
+  const char *content_type = get_mime_type(item->path);
+  char last_modified[32];
+  format_http_date(mtime, last_modified, sizeof(last_modified));
+
+  item->entry.path_length = (unsigned int) strlen(item->key);
+  item->entry.path_offset = append_string(item->key, item->entry.path_length);
+  item->entry.mtime = (long long) mtime;
+  item->entry.content_type_offset = append_string(content_type, strlen(content_type));
+  item->entry.last_modified_offset = append_string(last_modified, strlen(last_modified));
+
+  int rc = write_representation(item, ENCODING_IDENTITY, data, length, content_type, last_modified);
+
+  // 사이드카가 있으면 그대로, 없으면 압축할 가치가 있는 타입만 압축
+  for (int encoding = ENCODING_GZIP; rc == 0 && encoding < ENCODING_COUNT; encoding++) {
+    char sidecar_path[PATH_MAX];
+    snprintf(sidecar_path, sizeof(sidecar_path), "%s%s", item->path, ENCODING_SUFFIXES[encoding]);
+
+    size_t variant_length = 0;
+    char *variant = read_whole_file(sidecar_path, &variant_length);
+    if (!variant && is_compressible_type(content_type) && compress_supported((content_encoding) encoding)) {
+      if (compress_buffer((content_encoding) encoding, data, length, &variant, &variant_length) != 0) {
+        variant = NULL;
+      }
+    }
+    if (variant) {
+      rc = write_representation(item, (content_encoding) encoding, variant, variant_length,
+                                content_type, last_modified);
+      free(variant);
+    }
+  }
+
+  // 원본 헤더 블록 (다른 표현이 있으면 Vary)
+  if (rc == 0) {
+    bundle_representation *identity = &item->entry.representations[ENCODING_IDENTITY];
+    int varies = item->entry.representations[ENCODING_GZIP].present ||
+                 item->entry.representations[ENCODING_BR].present;
+    char header[1024];
+    int header_length = format_header_block(header, sizeof(header), content_type,
+                                            identity->data_length, NULL,
+                                            varies, identity->etag, last_modified);
+    if (header_length < 0) {
+      rc = -1;
+    } else {
+      identity->header_offset = append_string(header, (size_t) header_length);
+      identity->header_length = (unsigned int) header_length;
+    }
+  }
+
+  free(data);
+  return rc;
+}
+
+static int has_suffix(const char *name, const char *suffix) {
+  size_t name_length = strlen(name);
+  size_t suffix_length = strlen(suffix);
+  return name_length > suffix_length && _stricmp(name + name_length - suffix_length, suffix) == 0;
+}
+
+static time_t filetime_to_time(FILETIME value) {
+  unsigned long long ticks = ((unsigned long long) value.dwHighDateTime << 32) | value.dwLowDateTime;
+  return (time_t) ((ticks - 116444736000000000ULL) / 10000000ULL);
+}
+
+// dir_path 아래를 재귀 스캔 (prefix: 번들 키 접두사)
+static int scan_directory(const char *dir_path, const char *prefix) {
+  char pattern[PATH_MAX];
+  snprintf(pattern, sizeof(pattern), "%s\\*", dir_path);
+
+  WIN32_FIND_DATAA find_data;
+  HANDLE find = FindFirstFileA(pattern, &find_data);
+  if (find == INVALID_HANDLE_VALUE) return 0;
+
+  int rc = 0;
+  do {
+    const char *name = find_data.cFileName;
+    DWORD attributes = find_data.dwFileAttributes;
+
+    // 서버가 제공하지 않는 이름은 번들에도 넣지 않음
+    if (name[0] == '.' || (attributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) ||
+        (attributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+      continue;
+    }
+
+    char path[PATH_MAX];
+    char key[PATH_MAX];
+    snprintf(path, sizeof(path), "%s\\%s", dir_path, name);
+    snprintf(key, sizeof(key), "%s%s%s", prefix, prefix[0] ? "\\" : "", name);
+
+    if (attributes & FILE_ATTRIBUTE_DIRECTORY) {
+      rc = scan_directory(path, key);
+      continue;
+    }
+    if (has_suffix(name, ".gz") || has_suffix(name, ".br")) continue;
+
+    if (item_count == item_capacity) {
+      size_t capacity = item_capacity ? item_capacity * 2 : 64;
+      build_entry *grown = realloc(items, capacity * sizeof(build_entry));
+      if (!grown) {
+        rc = -1;
+        break;
+      }
+      items = grown;
+      item_capacity = capacity;
+    }
+
+    build_entry *item = &items[item_count];
+    memset(item, 0, sizeof(*item));
+    strcpy(item->path, path);
+    for (size_t i = 0; key[i]; i++) {
+      item->key[i] = (char) tolower((unsigned char) key[i]);
+    }
+
+    rc = pack_file(item, filetime_to_time(find_data.ftLastWriteTime));
+    if (rc == 0) {
+      printf("  %s (%llu bytes)\n", item->key,
+             item->entry.representations[ENCODING_IDENTITY].data_length);
+      item_count++;
+    }
+  } while (rc == 0 && FindNextFileA(find, &find_data));
+
+  FindClose(find);
+  return rc;
+}
+
+// 완전 해시 변위 계산 (큰 버킷부터 빈 슬롯에 들어가는 변위를 찾음)
+static int build_displacements(unsigned int bucket_count, unsigned int *displacements, size_t *slot_of) {
+  unsigned int entry_count = (unsigned int) item_count;
+  unsigned int *bucket_of = malloc(entry_count * sizeof(unsigned int));
+  unsigned int *bucket_size = calloc(bucket_count, sizeof(unsigned int));
+  unsigned int *order = malloc(bucket_count * sizeof(unsigned int));
+  unsigned char *taken = calloc(entry_count, 1);
+  unsigned int *slots = malloc(entry_count * sizeof(unsigned int));
+  int rc = -1;
+  if (!bucket_of || !bucket_size || !order || !taken || !slots) goto cleanup;
+
+  for (unsigned int i = 0; i < entry_count; i++) {
+    bucket_of[i] = bundle_bucket(items[i].key, strlen(items[i].key), bucket_count);
+    bucket_size[bucket_of[i]]++;
+  }
+
+  // 버킷 크기 내림차순 (삽입 정렬, 빌드 시 한 번)
+  for (unsigned int i = 0; i < bucket_count; i++) {
+    unsigned int j = i;
+    while (j > 0 && bucket_size[order[j - 1]] < bucket_size[i]) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+
+  memset(displacements, 0, bucket_count * sizeof(unsigned int));
+  for (unsigned int b = 0; b < bucket_count && bucket_size[order[b]] > 0; b++) {
+    unsigned int bucket = order[b];
+    unsigned int displacement;
+    for (displacement = 1; displacement < MAX_DISPLACEMENT; displacement++) {
+      unsigned int count = 0;
+      int fits = 1;
+      for (unsigned int i = 0; i < entry_count && fits; i++) {
+        if (bucket_of[i] != bucket) continue;
+        unsigned int slot = bundle_slot(items[i].key, strlen(items[i].key), displacement, entry_count);
+        if (taken[slot]) fits = 0;
+        for (unsigned int k = 0; k < count && fits; k++) {
+          if (slots[k] == slot) fits = 0;
+        }
+        slots[count++] = slot;
+      }
+      if (fits) break;
+    }
+    if (displacement == MAX_DISPLACEMENT) goto cleanup;
+
+    displacements[bucket] = displacement;
+    for (unsigned int i = 0; i < entry_count; i++) {
+      if (bucket_of[i] != bucket) continue;
+      unsigned int slot = bundle_slot(items[i].key, strlen(items[i].key), displacement, entry_count);
+      taken[slot] = 1;
+      slot_of[i] = slot;
+    }
+  }
+  rc = 0;
+
+cleanup:
+  free(bucket_of);
+  free(bucket_size);
+  free(order);
+  free(taken);
+  free(slots);
+  return rc;
+}
+
+// 문자열 오프셋을 파일 기준으로 보정
+static void relocate_strings(bundle_entry *entry, unsigned long long base) {
+  entry->path_offset += base;
+  entry->content_type_offset += base;
+  entry->last_modified_offset += base;
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    if (entry->representations[encoding].present) {
+      entry->representations[encoding].header_offset += base;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    fprintf(stderr, "Usage: %s <static_dir> <output> [mime.types]\n", argv[0]);
+    return 1;
+  }
+
+  if (mime_types_init(argc > 3 ? argv[3] : NULL) != 0) {
+    fprintf(stderr, "Failed to build MIME type table\n");
+    return 1;
+  }
+
+  output = fopen(argv[2], "wb");
+  if (!output) {
+    fprintf(stderr, "Failed to create %s\n", argv[2]);
+    return 1;
+  }
+
+  // 헤더 자리 (마지막에 다시 기록)
+  bundle_header header = {0};
+  int rc = write_bytes(&header, sizeof(header));
+
+  printf("Packing %s\n", argv[1]);
+  if (rc == 0) rc = scan_directory(argv[1], "");
+
+  // 문자열 영역
+  unsigned long long strings_offset = output_offset;
+  if (rc == 0) rc = write_bytes(strings, strings_length);
+
+  // 변위 테이블 (엔트리 4개당 버킷 하나, 실패하면 버킷을 늘려 재시도)
+  unsigned int bucket_count = (unsigned int) (item_count / 4 + 1);
+  unsigned int *displacements = NULL;
+  size_t *slot_of = malloc((item_count + 1) * sizeof(size_t));
+  while (rc == 0) {
+    free(displacements);
+    displacements = malloc(bucket_count * sizeof(unsigned int));
+    if (!displacements || !slot_of) {
+      rc = -1;
+      break;
+    }
+    if (item_count == 0 || build_displacements(bucket_count, displacements, slot_of) == 0) break;
+    bucket_count *= 2;
+  }
+
+  unsigned long long displacement_offset = 0;
+  if (rc == 0) rc = write_padding(sizeof(unsigned int));
+  if (rc == 0) {
+    displacement_offset = output_offset;
+    rc = write_bytes(displacements, bucket_count * sizeof(unsigned int));
+  }
+
+  // 엔트리 테이블 (슬롯 순서)
+  bundle_entry *table = calloc(item_count + 1, sizeof(bundle_entry));
+  unsigned long long entry_offset = 0;
+  if (rc == 0 && !table) rc = -1;
+  if (rc == 0) rc = write_padding(sizeof(unsigned long long));
+  if (rc == 0) {
+    for (size_t i = 0; i < item_count; i++) {
+      table[slot_of[i]] = items[i].entry;
+      relocate_strings(&table[slot_of[i]], strings_offset);
+    }
+    entry_offset = output_offset;
+    rc = write_bytes(table, item_count * sizeof(bundle_entry));
+  }
+
+  // 헤더 기록
+  if (rc == 0) {
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+    header.version = BUNDLE_VERSION;
+    header.entry_count = (unsigned int) item_count;
+    header.bucket_count = bucket_count;
+    header.displacement_offset = displacement_offset;
+    header.entry_offset = entry_offset;
+    header.file_size = output_offset;
+    if (fseek(output, 0, SEEK_SET) != 0 || fwrite(&header, 1, sizeof(header), output) != sizeof(header)) {
+      rc = -1;
+    }
+  }
+
+  if (fclose(output) != 0) rc = -1;
+  if (rc != 0) {
+    fprintf(stderr, "Failed to build bundle\n");
+    remove(argv[2]);
+  } else {
+    printf("Bundle written: %s (%zu files, %u buckets, %llu bytes)\n",
+           argv[2], item_count, bucket_count, header.file_size);
+  }
+
+  free(table);
+  free(displacements);
+  free(slot_of);
+  free(items);
+  free(strings);
+  mime_types_cleanup();
+  return rc == 0 ? 0 : 1;
+}
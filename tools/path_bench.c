@@ -0,0 +1,406 @@
+/*
+ * 경로 정규화 벤치마크 및 차등 테스트
+ * 사용법: path_bench [반복 횟수] [무작위 경로 수]
+ * 1. 이전 is_path_safe 파이프라인(strstr 검사, 반복 디코딩, strtok 순회)을 그대로 옮겨 기준으로 사용
+ * 2. 고정 경로 목록 + 고정 시드 무작위 경로로 두 구현의 결과 비교
+ * 3. 같은 입력을 반복해 경로당 처리 시간 비교
+ *
+ * 실패 조건 (종료 코드 1)
+ * - 새 구현이 받아들인 결과에 "..", ".", 빈 컴포넌트, 숨김 컴포넌트, 금지 문자가 남음
+ * - 두 구현이 모두 받아들였는데 정규화 결과가 다름 ('+'는 이전 구현만 공백으로 바꾸므로 제외)
+ * 새 구현만 거부하는 경로(더 엄격한 규칙)와 루트 안의 ".."처럼 새 구현만 받아들이는 경로는 개수만 보고
+ */
+
+#include "path_canon.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <time.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+#ifdef _WIN32
+#define PATH_SEPARATOR '\\'
+#else
+#define PATH_SEPARATOR '/'
+#endif
+
+#define DEFAULT_ITERATIONS 20
+#define DEFAULT_RANDOM_PATHS 200000
+#define RANDOM_PATH_MAX 24 // 무작위 경로 최대 길이
+#define MAX_EXAMPLES 5 // 분류별로 출력할 예
+
+// ---- 이전 구현 (a80102e 이전 src/file_handler.c, 로그 출력만 제거) ----
+
+static int legacy_unicode_to_utf8(unsigned int code, char *dst) {
+  if (code <= 0x7F) {
+    dst[0] = (char) code;
+    return 1;
+  } else if (code <= 0x7FF) {
+    dst[0] = (char) (0xC0 | (code >> 6));
+    dst[1] = (char) (0x80 | (code & 0x3F));
+    return 2;
+  } else if (code <= 0xFFFF) {
+    dst[0] = (char) (0xE0 | (code >> 12));
+    dst[1] = (char) (0x80 | ((code >> 6) & 0x3F));
+    dst[2] = (char) (0x80 | (code & 0x3F));
+    return 3;
+  } else if (code <= 0x10FFFF) {
+    dst[0] = (char) (0xF0 | (code >> 18));
+    dst[1] = (char) (0x80 | ((code >> 12) & 0x3F));
+    dst[2] = (char) (0x80 | ((code >> 6) & 0x3F));
+    dst[3] = (char) (0x80 | (code & 0x3F));
+    return 4;
+  }
+  return -1;
+}
+
+// 원본은 16진수가 아닌 '%'나 잘못된 %u에서 src를 넘기지 않아 무한 반복
+// 비교를 끝내기 위해 그 경우에만 문자를 그대로 복사하고 넘어감
+static void legacy_url_decode(char *dst, const char *src) {
+  while (*src) {
+    if (*src == '%' && src[1] && src[2]) {
+      char a = src[1];
+      if ((a == 'u' || a == 'U') && src[2] && src[3] && src[4] && src[5]) {
+        if (isxdigit((unsigned char) src[2]) && isxdigit((unsigned char) src[3]) &&
+            isxdigit((unsigned char) src[4]) && isxdigit((unsigned char) src[5])) {
+          char code_str[5] = {src[2], src[3], src[4], src[5], '\0'};
+          unsigned int code;
+          sscanf(code_str, "%x", &code);
+          int len = legacy_unicode_to_utf8(code, dst);
+          if (len > 0) {
+            dst += len;
+            src += 6;
+            continue;
+          }
+        }
+      } else if (isxdigit((unsigned char) a) && isxdigit((unsigned char) src[2])) {
+        char b = src[2];
+        a = (char) tolower((unsigned char) a);
+        b = (char) tolower((unsigned char) b);
+        a = (char) ((a >= 'a') ? a - 'a' + 10 : a - '0');
+        b = (char) ((b >= 'a') ? b - 'a' + 10 : b - '0');
+        *dst++ = (char) (a * 16 + b);
+        src += 3;
+        continue;
+      }
+      *dst++ = *src++; // 추가: 무한 반복 방지
+    } else if (*src == '+') {
+      *dst++ = ' ';
+      src++;
+    } else {
+      *dst++ = *src++;
+    }
+  }
+  *dst = '\0';
+}
+
+static void legacy_recursive_url_decode(char *dst, const char *src) {
+  char temp[PATH_MAX];
+  strcpy(temp, src);
+  char decoded[PATH_MAX];
+  while (1) {
+    legacy_url_decode(decoded, temp);
+    if (strcmp(decoded, temp) == 0) break;
+    strcpy(temp, decoded);
+  }
+  strcpy(dst, decoded);
+}
+
+// 안전하면 1과 정규화된 경로 (out), 아니면 0
+// strtok_r과 같은 분리 (빈 토큰은 건너뜀, POSIX 확장 없이 C11만으로 빌드되도록 직접 구현)
+static char *legacy_next_token(char **cursor, const char *delimiters) {
+  char *token = *cursor + strspn(*cursor, delimiters);
+  if (!*token) {
+    *cursor = token;
+    return NULL;
+  }
+  char *end = token + strcspn(token, delimiters);
+  if (*end) *end++ = '\0';
+  *cursor = end;
+  return token;
+}
+
+static int legacy_is_path_safe(const char *path, char *out) {
+  if (!path || !*path) return 0;
+
+  if (strstr(path, "..") || strstr(path, "%2e%2e") || strstr(path, "%2E%2E") ||
+      strstr(path, "%u2e%u2e") || strstr(path, "%c0%2e") ||
+      strstr(path, "%u2215") || strstr(path, "%c0%af") ||
+      strstr(path, "%u002e") || strstr(path, "%u002E") ||
+      strstr(path, "%00") || strstr(path, "\\0") ||
+      strstr(path, "%5c") || strstr(path, "%2f") ||
+      strstr(path, "....")) {
+    return 0;
+  }
+
+  char decoded_path[PATH_MAX];
+  legacy_recursive_url_decode(decoded_path, path);
+
+  char path_copy[PATH_MAX];
+  strcpy(path_copy, decoded_path); // 원본은 strncpy (같은 크기 버퍼라 결과 동일)
+  char *cursor = path_copy;
+  char *token = legacy_next_token(&cursor, "/\\");
+  int depth = 0;
+
+  while (token) {
+    if (strstr(token, "..") || strstr(token, "....")) return 0;
+
+    size_t suspicious_count = 0;
+    size_t token_len = strlen(token);
+    for (size_t i = 0; i < token_len; i++) {
+      if (!isalnum((unsigned char) token[i]) && token[i] != '.' && token[i] != '-' && token[i] != '_') {
+        suspicious_count++;
+      }
+    }
+    if (suspicious_count > token_len / 2) return 0;
+
+    if (strcmp(token, "..") == 0) {
+      depth--;
+      if (depth < 0) return 0;
+    } else if (strcmp(token, ".") != 0) {
+      depth++;
+    }
+
+    token = legacy_next_token(&cursor, "/\\");
+  }
+
+  char *src = decoded_path;
+  char *dst = decoded_path;
+  while (*src) {
+    if ((*src == '/' || *src == '\\') && (*(src + 1) == '/' || *(src + 1) == '\\')) {
+      src++;
+      continue;
+    }
+    if (*src == '/' || *src == '\\') {
+      *dst++ = PATH_SEPARATOR;
+    } else {
+      *dst++ = *src;
+    }
+    src++;
+  }
+  *dst = '\0';
+
+  const char *filename = strrchr(decoded_path, PATH_SEPARATOR);
+  filename = filename ? filename + 1 : decoded_path;
+  if (filename[0] == '.') return 0;
+
+  strcpy(out, decoded_path);
+  return 1;
+}
+
+// ---- 비교 ----
+
+// 이전 결과를 새 결과 형식으로 (앞뒤 구분자, 빈 컴포넌트, "." 컴포넌트 제거)
+static void legacy_to_relative(const char *legacy, char *out) {
+  size_t len = 0;
+  const char *p = legacy;
+  while (*p) {
+    while (*p == PATH_SEPARATOR) p++;
+    const char *start = p;
+    while (*p && *p != PATH_SEPARATOR) p++;
+    size_t seg_len = (size_t) (p - start);
+    if (seg_len == 0 || (seg_len == 1 && start[0] == '.')) continue;
+    if (len > 0) out[len++] = PATH_SEPARATOR;
+    memcpy(out + len, start, seg_len);
+    len += seg_len;
+  }
+  out[len] = '\0';
+}
+
+// 새 구현이 받아들인 결과가 루트 안의 평범한 상대 경로인지
+static int canonical_is_safe(const char *canonical) {
+  const char *p = canonical;
+  if (*p == PATH_SEPARATOR) return 0;
+  while (1) {
+    const char *start = p;
+    while (*p && *p != PATH_SEPARATOR) {
+      unsigned char c = (unsigned char) *p;
+      if (c < 0x20 || c == 0x7F || c == ':' || c == '/' || c == '\\') return 0; // 남은 구분자 포함
+      p++;
+    }
+    size_t seg_len = (size_t) (p - start);
+    if (*canonical) {
+      if (seg_len == 0 || start[0] == '.') return 0; // 빈 컴포넌트, ".", "..", 숨김
+      if (start[seg_len - 1] == '.' || start[seg_len - 1] == ' ') return 0;
+    }
+    if (!*p) break;
+    p++;
+  }
+  return 1;
+}
+
+typedef enum {
+  CLASS_SAME_ACCEPT, // 둘 다 허용, 결과 같음
+  CLASS_SAME_REJECT, // 둘 다 거부
+  CLASS_STRICTER, // 새 구현만 거부
+  CLASS_DOT_RESOLVED, // 새 구현만 허용: 루트 안의 점 세그먼트 처리, 이름 안의 ".."
+  CLASS_PLUS_LITERAL, // 새 구현만 허용 또는 결과 다름: '+'를 그대로 둠
+  CLASS_HEURISTIC, // 새 구현만 허용: 이전 구현의 '의심 문자 비율' 거부
+  CLASS_OUTPUT_DIFF, // 실패: 둘 다 허용했는데 결과가 다름
+  CLASS_UNSAFE, // 실패: 새 구현 결과가 안전하지 않음
+  CLASS_COUNT
+} diff_class;
+
+static const char *const CLASS_NAMES[CLASS_COUNT] = {
+  "both accept, same result",
+  "both reject",
+  "new rejects only (stricter)",
+  "new accepts only: dot segments inside root",
+  "'+' kept literal",
+  "new accepts only: no suspicious-ratio heuristic",
+  "FAIL: both accept, results differ",
+  "FAIL: unsafe canonical result"
+};
+
+static long class_counts[CLASS_COUNT];
+static int class_examples[CLASS_COUNT];
+
+static diff_class classify(const char *path) {
+  char canonical[PATH_MAX];
+  char legacy[PATH_MAX];
+  char legacy_relative[PATH_MAX];
+
+  int new_ok = canonicalize_path(path, canonical, sizeof(canonical)) == PATH_OK;
+  int old_ok = legacy_is_path_safe(path, legacy);
+
+  if (new_ok && !canonical_is_safe(canonical)) return CLASS_UNSAFE;
+  if (!new_ok) return old_ok ? CLASS_STRICTER : CLASS_SAME_REJECT;
+
+  if (!old_ok) {
+    if (strstr(path, "..") || strstr(path, "/.") || strstr(path, "\\.") ||
+        strstr(path, "%2e") || strstr(path, "%2E")) {
+      return CLASS_DOT_RESOLVED;
+    }
+    if (strchr(path, '+')) return CLASS_PLUS_LITERAL;
+    return CLASS_HEURISTIC;
+  }
+
+  legacy_to_relative(legacy, legacy_relative);
+  if (strcmp(canonical, legacy_relative) == 0) return CLASS_SAME_ACCEPT;
+  return strchr(path, '+') ? CLASS_PLUS_LITERAL : CLASS_OUTPUT_DIFF;
+}
+
+static void record(const char *path) {
+  diff_class result = classify(path);
+  class_counts[result]++;
+  if (result >= CLASS_STRICTER && class_examples[result] < MAX_EXAMPLES) {
+    class_examples[result]++;
+    printf("  [%s] %s\n", CLASS_NAMES[result], path);
+  }
+}
+
+// ---- 입력 ----
+
+static const char *const FIXED_PATHS[] = {
+  "/", "/index.html", "/css/style.css", "//images//logo.png", "/a/./b/../c.txt",
+  "/../secret", "/%2e%2e/secret", "/%2E%2E%2fsecret", "/a/%2e%2e/b", "/%252e%252e/secret",
+  "/%u002e%u002e/secret", "/%c0%ae%c0%ae/secret", "/%c0%af", "/test.txt%00.html",
+  "/test.txt::$DATA", "/.hidden", "/dir/.git/config", "/file.", "/file%20", "/a%5cb",
+  "/a%2fb", "/my%20file.txt", "/a+b.txt", "/%41%42C.txt", "/a\\b\\c.txt", "/....//x",
+  "/%", "/%4", "/%zz", "/%%41", "/a b c.txt", "/\xed\x95\x9c\xea\xb8\x80.txt", "/a\tb",
+  "/CON", "/dir/sub/", "/./", "/a/b/c/../../../..", "\\..\\windows", "/a..b.txt"
+};
+
+// 재현 가능한 무작위 경로 (경계 사례가 자주 나오도록 문자 집합 제한)
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned int next_random(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (unsigned int) (rng_state >> 32);
+}
+
+static void random_path(char *out) {
+  static const char *const PIECES[] = {
+    "a", "b", "x.txt", ".", "..", "/", "/", "//", "\\", "%", "%2e", "%2E", "%2f", "%5c",
+    "%00", "%25", "%41", "%u002e", "%c0", "+", " ", ":", "-", "_", "%20", "\x7f"
+  };
+  const size_t piece_count = sizeof(PIECES) / sizeof(PIECES[0]);
+
+  size_t len = 0;
+  out[len++] = '/';
+  size_t pieces = 1 + next_random() % 8;
+  for (size_t i = 0; i < pieces; i++) {
+    const char *piece = PIECES[next_random() % piece_count];
+    size_t piece_len = strlen(piece);
+    if (len + piece_len >= RANDOM_PATH_MAX) break;
+    memcpy(out + len, piece, piece_len);
+    len += piece_len;
+  }
+  out[len] = '\0';
+}
+
+// ---- 벤치마크 ----
+
+typedef int (*path_fn)(const char *path);
+
+static int run_new(const char *path) {
+  char canonical[PATH_MAX];
+  return canonicalize_path(path, canonical, sizeof(canonical)) == PATH_OK;
+}
+
+static int run_legacy(const char *path) {
+  char legacy[PATH_MAX];
+  return legacy_is_path_safe(path, legacy);
+}
+
+static double bench(path_fn fn, char (*paths)[RANDOM_PATH_MAX + 1], size_t count, int iterations, long *accepted) {
+  clock_t start = clock();
+  long total = 0;
+  for (int i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < count; j++) {
+      total += fn(paths[j]);
+    }
+  }
+  clock_t end = clock();
+  *accepted = total;
+  return (double) (end - start) / CLOCKS_PER_SEC * 1e9 / ((double) count * iterations);
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+  long random_count = argc > 2 ? atol(argv[2]) : DEFAULT_RANDOM_PATHS;
+  if (iterations <= 0 || random_count <= 0) {
+    fprintf(stderr, "Usage: %s [iterations] [random_paths]\n", argv[0]);
+    return 2;
+  }
+
+  char (*paths)[RANDOM_PATH_MAX + 1] = malloc((size_t) random_count * sizeof(*paths));
+  if (!paths) {
+    fprintf(stderr, "Out of memory\n");
+    return 2;
+  }
+  for (long i = 0; i < random_count; i++) {
+    random_path(paths[i]);
+  }
+
+  printf("=== Differential test ===\n");
+  for (size_t i = 0; i < sizeof(FIXED_PATHS) / sizeof(FIXED_PATHS[0]); i++) {
+    record(FIXED_PATHS[i]);
+  }
+  for (long i = 0; i < random_count; i++) {
+    record(paths[i]);
+  }
+  for (int i = 0; i < CLASS_COUNT; i++) {
+    printf("%-50s %ld\n", CLASS_NAMES[i], class_counts[i]);
+  }
+  int failed = class_counts[CLASS_OUTPUT_DIFF] > 0 || class_counts[CLASS_UNSAFE] > 0;
+
+  printf("\n=== Benchmark (%ld paths x %d) ===\n", random_count, iterations);
+  long legacy_accepted, new_accepted;
+  double legacy_ns = bench(run_legacy, paths, (size_t) random_count, iterations, &legacy_accepted);
+  double new_ns = bench(run_new, paths, (size_t) random_count, iterations, &new_accepted);
+  printf("is_path_safe (old):  %8.1f ns/path\n", legacy_ns);
+  printf("canonicalize_path:   %8.1f ns/path\n", new_ns);
+  if (new_ns > 0) printf("speedup:             %8.1fx\n", legacy_ns / new_ns);
+
+  free(paths);
+  printf("\n%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? 1 : 0;
+}